@@ -0,0 +1,91 @@
+/*
+ * Copyright © 2026 Collabora Limited
+ *
+ * This file is part of the glmark2 OpenGL (ES) 2.0 benchmark.
+ *
+ * glmark2 is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * glmark2 is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * glmark2.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "asset-prefetcher.h"
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+namespace
+{
+
+std::mutex prefetch_mutex;
+std::condition_variable prefetch_cv;
+std::deque<std::function<void()>> prefetch_tasks;
+bool prefetch_stop = false;
+std::thread prefetch_thread;
+
+void
+run_prefetch_thread()
+{
+    std::unique_lock<std::mutex> lock(prefetch_mutex);
+
+    while (true) {
+        prefetch_cv.wait(lock, [] { return prefetch_stop || !prefetch_tasks.empty(); });
+        if (prefetch_stop)
+            break;
+
+        std::function<void()> task(std::move(prefetch_tasks.front()));
+        prefetch_tasks.pop_front();
+
+        lock.unlock();
+        task();
+        lock.lock();
+    }
+}
+
+}
+
+bool AssetPrefetcher::enabled_ = false;
+
+void
+AssetPrefetcher::init()
+{
+    prefetch_thread = std::thread(run_prefetch_thread);
+    enabled_ = true;
+}
+
+void
+AssetPrefetcher::add_task(const std::function<void()> &task)
+{
+    {
+        std::lock_guard<std::mutex> lock(prefetch_mutex);
+        prefetch_tasks.push_back(task);
+    }
+
+    prefetch_cv.notify_one();
+}
+
+void
+AssetPrefetcher::finish()
+{
+    if (!enabled_)
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(prefetch_mutex);
+        prefetch_stop = true;
+        prefetch_tasks.clear();
+    }
+
+    prefetch_cv.notify_one();
+    prefetch_thread.join();
+    enabled_ = false;
+}
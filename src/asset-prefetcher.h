@@ -0,0 +1,63 @@
+/*
+ * Copyright © 2026 Collabora Limited
+ *
+ * This file is part of the glmark2 OpenGL (ES) 2.0 benchmark.
+ *
+ * glmark2 is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * glmark2 is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * glmark2.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef GLMARK2_ASSET_PREFETCHER_H_
+#define GLMARK2_ASSET_PREFETCHER_H_
+
+#include <functional>
+
+/**
+ * A background thread that loads the CPU-side assets of the next benchmark
+ * (parsed models and decoded images) while the current one runs.
+ *
+ * The prefetcher only runs tasks in order; Model::prefetch() and
+ * Texture::prefetch() queue the actual loading, and Model::load() and
+ * Texture::load() pick up the results, waiting for them if needed. All GL
+ * calls stay on the main thread.
+ */
+class AssetPrefetcher
+{
+public:
+    /**
+     * Starts the prefetching thread.
+     */
+    static void init();
+
+    /**
+     * Whether prefetching is enabled.
+     */
+    static bool enabled() { return enabled_; }
+
+    /**
+     * Queues a task to run on the prefetching thread.
+     *
+     * @param task the task, which must not make any GL calls
+     */
+    static void add_task(const std::function<void()> &task);
+
+    /**
+     * Stops the prefetching thread, discarding any tasks that haven't
+     * started yet.
+     */
+    static void finish();
+
+private:
+    static bool enabled_;
+};
+
+#endif /* GLMARK2_ASSET_PREFETCHER_H_ */
@@ -0,0 +1,221 @@
+/*
+ * Copyright © 2026 Collabora Limited
+ *
+ * This file is part of the glmark2 OpenGL (ES) 2.0 benchmark.
+ *
+ * glmark2 is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * glmark2 is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * glmark2.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "baseline.h"
+#include "log.h"
+#include "results-reader.h"
+#include "statistics.h"
+#include "util.h"
+
+#include <cmath>
+#include <map>
+
+namespace
+{
+
+struct BaselineEntry {
+    /* The average frame time of each run of the benchmark */
+    std::vector<double> run_frame_times;
+    /* The time of each frame of all the runs, if available */
+    std::vector<double> frame_times;
+};
+
+std::map<std::string, BaselineEntry> baseline_entries;
+std::vector<Baseline::Comparison> comparisons;
+double baseline_max_regression = 0.05;
+
+/**
+ * Whether the difference between the means of two sets of samples is
+ * statistically significant at the 95% level.
+ *
+ * Uses Welch's t-test if both sets have multiple samples. If only one set
+ * has multiple samples, checks whether the single sample of the other set
+ * falls outside the 95% prediction interval. Without any information about
+ * the noise, all differences are considered significant.
+ */
+bool
+significant_difference(const std::vector<double> &a, const std::vector<double> &b)
+{
+    if (a.size() < 2 && b.size() < 2)
+        return true;
+
+    if (a.size() < 2 || b.size() < 2) {
+        const std::vector<double> &many = a.size() < 2 ? b : a;
+        double single = a.size() < 2 ? Statistics::mean(a) : Statistics::mean(b);
+        double mean = Statistics::mean(many);
+        double sd = Statistics::stddev(many, mean);
+        double t = Statistics::t_critical_95(many.size() - 1);
+
+        return std::fabs(single - mean) > t * sd * std::sqrt(1.0 + 1.0 / many.size());
+    }
+
+    RunningStats stats_a;
+    RunningStats stats_b;
+    for (auto s : a)
+        stats_a.add(s);
+    for (auto s : b)
+        stats_b.add(s);
+
+    double half_width = Statistics::welch_ci95_half_width(stats_a, stats_b);
+
+    if (half_width == 0.0)
+        return stats_a.mean() != stats_b.mean();
+
+    return std::fabs(stats_a.mean() - stats_b.mean()) > half_width;
+}
+
+}
+
+bool Baseline::enabled_ = false;
+
+bool
+Baseline::init(const std::string &file, double max_regression)
+{
+    if (file.empty())
+        return true;
+
+    baseline_max_regression = max_regression;
+
+    bool ok = ResultsReader::read(file, [](const BenchmarkResult &result) {
+        double frame_time = result.average_frame_time();
+
+        if (result.status != "Success" || frame_time <= 0.0)
+            return;
+
+        BaselineEntry &entry = baseline_entries[result.name];
+        entry.run_frame_times.push_back(frame_time);
+        entry.frame_times.insert(entry.frame_times.end(),
+                                 result.frame_times.begin(),
+                                 result.frame_times.end());
+    });
+
+    if (!ok)
+        return false;
+
+    Log::debug("Loaded baseline results for %u benchmarks from %s\n",
+               static_cast<unsigned>(baseline_entries.size()), file.c_str());
+
+    enabled_ = true;
+
+    return true;
+}
+
+Baseline::Comparison
+Baseline::compare(const std::string &name, double average_frame_time,
+                  const std::vector<double> &frame_times)
+{
+    Comparison comparison;
+
+    comparison.name = name;
+    comparison.status = StatusMissing;
+    comparison.baseline_frame_time = 0.0;
+    comparison.current_frame_time = 1000.0 * average_frame_time;
+    comparison.change = 0.0;
+
+    auto iter = baseline_entries.find(name);
+    if (iter == baseline_entries.end()) {
+        comparisons.push_back(comparison);
+        return comparison;
+    }
+
+    const BaselineEntry &entry = iter->second;
+
+    comparison.baseline_frame_time = Statistics::mean(entry.run_frame_times);
+    comparison.change = comparison.current_frame_time / comparison.baseline_frame_time - 1.0;
+
+    /*
+     * Use the per-frame samples if both runs have them, otherwise the
+     * per-run averages of the baseline.
+     */
+    bool significant;
+    if (!entry.frame_times.empty() && !frame_times.empty()) {
+        std::vector<double> current(frame_times.size());
+        for (size_t i = 0; i < frame_times.size(); i++)
+            current[i] = 1000.0 * frame_times[i];
+        significant = significant_difference(entry.frame_times, current);
+    }
+    else {
+        significant = significant_difference(entry.run_frame_times,
+                                             {comparison.current_frame_time});
+    }
+
+    if (significant && comparison.change > baseline_max_regression)
+        comparison.status = StatusRegression;
+    else if (significant && comparison.change < -baseline_max_regression)
+        comparison.status = StatusImprovement;
+    else
+        comparison.status = StatusUnchanged;
+
+    comparisons.push_back(comparison);
+
+    return comparison;
+}
+
+const char *
+Baseline::status_name(Status status)
+{
+    static const char *names[] = {"missing", "unchanged", "improvement", "regression"};
+
+    return names[status];
+}
+
+void
+Baseline::log_summary()
+{
+    if (!enabled_)
+        return;
+
+    unsigned int regressions = 0;
+
+    Log::info("=======================================================\n");
+    Log::info("    Baseline comparison (max regression: %s%%)\n",
+              Util::toString(100.0 * baseline_max_regression, 1).c_str());
+    Log::info("=======================================================\n");
+    Log::info("    %10s %10s %8s  %-11s %s\n",
+              "Base (ms)", "Cur (ms)", "Change", "Status", "Benchmark");
+
+    for (auto const& c : comparisons) {
+        std::string base = c.status == StatusMissing ?
+            "n/a" : Util::toString(c.baseline_frame_time, 3);
+        std::string change = c.status == StatusMissing ?
+            "n/a" : (c.change >= 0.0 ? "+" : "") + Util::toString(100.0 * c.change, 1) + "%";
+
+        Log::info("    %10s %10s %8s  %-11s %s\n",
+                  base.c_str(), Util::toString(c.current_frame_time, 3).c_str(),
+                  change.c_str(), status_name(c.status), c.name.c_str());
+
+        if (c.status == StatusRegression)
+            regressions++;
+    }
+
+    Log::info("=======================================================\n");
+    Log::info("    %u regression(s) in %u benchmark(s)\n",
+              regressions, static_cast<unsigned>(comparisons.size()));
+    Log::info("=======================================================\n");
+}
+
+bool
+Baseline::regressed()
+{
+    for (auto const& c : comparisons) {
+        if (c.status == StatusRegression)
+            return true;
+    }
+
+    return false;
+}
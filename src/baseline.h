@@ -0,0 +1,100 @@
+/*
+ * Copyright © 2026 Collabora Limited
+ *
+ * This file is part of the glmark2 OpenGL (ES) 2.0 benchmark.
+ *
+ * glmark2 is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * glmark2 is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * glmark2.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef GLMARK2_BASELINE_H_
+#define GLMARK2_BASELINE_H_
+
+#include <string>
+#include <vector>
+
+/**
+ * Compares benchmark results against the results of a previous run.
+ *
+ * A benchmark has regressed if its average frame time has increased by
+ * more than the allowed amount, and the increase is statistically
+ * significant given the noise in the measurements.
+ */
+class Baseline
+{
+public:
+    enum Status {
+        StatusMissing,
+        StatusUnchanged,
+        StatusImprovement,
+        StatusRegression
+    };
+
+    struct Comparison {
+        std::string name;
+        Status status;
+        /** The average frame times in ms */
+        double baseline_frame_time;
+        double current_frame_time;
+        /** The relative change of the average frame time */
+        double change;
+    };
+
+    /**
+     * Loads the baseline results.
+     *
+     * @param file the JSON results file to load, or an empty string to
+     *             disable comparisons
+     * @param max_regression the largest allowed relative increase of the
+     *                       average frame time
+     *
+     * @return whether the operation succeeded
+     */
+    static bool init(const std::string &file, double max_regression);
+
+    /**
+     * Whether comparisons are enabled.
+     */
+    static bool enabled() { return enabled_; }
+
+    /**
+     * Compares the result of a benchmark against the baseline.
+     *
+     * @param name the benchmark name, as returned by Scene::info_string()
+     * @param average_frame_time the average frame time in seconds
+     * @param frame_times the time of each frame in seconds
+     *
+     * @return the comparison
+     */
+    static Comparison compare(const std::string &name, double average_frame_time,
+                              const std::vector<double> &frame_times);
+
+    /**
+     * Gets the name of a status, as used in the results.
+     */
+    static const char *status_name(Status status);
+
+    /**
+     * Logs a table with all the comparisons made so far.
+     */
+    static void log_summary();
+
+    /**
+     * Whether any benchmark has regressed.
+     */
+    static bool regressed();
+
+private:
+    static bool enabled_;
+};
+
+#endif /* GLMARK2_BASELINE_H_ */
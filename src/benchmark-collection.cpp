@@ -38,7 +38,8 @@ BenchmarkCollection::add(const std::vector<std::string> &benchmarks)
          iter != benchmarks.end();
          iter++)
     {
-        benchmarks_.push_back(new Benchmark(*iter));
+        std::vector<Benchmark *> created(Benchmark::create_from_description(*iter));
+        benchmarks_.insert(benchmarks_.end(), created.begin(), created.end());
     }
 }
 
@@ -90,8 +91,11 @@ BenchmarkCollection::add_benchmarks_from_files()
             std::string line;
 
             while (getline(ifs, line)) {
-                if (!line.empty())
-                    benchmarks_.push_back(new Benchmark(line));
+                if (line.empty())
+                    continue;
+
+                std::vector<Benchmark *> created(Benchmark::create_from_description(line));
+                benchmarks_.insert(benchmarks_.end(), created.begin(), created.end());
             }
         }
         else {
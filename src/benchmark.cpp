@@ -22,8 +22,14 @@
 
 #include "benchmark.h"
 #include "log.h"
+#include "model.h"
+#include "texture.h"
 #include "util.h"
 
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
 using std::string;
 using std::vector;
 using std::map;
@@ -68,6 +74,158 @@ get_options_from_description(const string &s)
     return options;
 }
 
+/**
+ * Parses a number, failing if there are any extra characters.
+ */
+static bool
+parse_sweep_number(const string &s, double &d)
+{
+    char *end;
+
+    d = strtod(s.c_str(), &end);
+
+    return !s.empty() && *end == '\0' && std::isfinite(d);
+}
+
+/**
+ * Formats a swept value, writing integers without a fractional part.
+ */
+static string
+format_sweep_number(double d)
+{
+    if (std::fabs(d - std::round(d)) < 1e-9)
+        return Util::toString(static_cast<long long>(std::round(d)));
+
+    return Util::toString(d);
+}
+
+/**
+ * Expands an option value that may be a sweep.
+ *
+ * @param value the option value
+ * @param values the expanded values
+ *
+ * @return whether the value is a valid sweep
+ */
+static bool
+expand_sweep_value(const string &value, vector<string> &values)
+{
+    static const size_t max_values = 10000;
+
+    values.clear();
+
+    if (value.size() >= 2 && value.front() == '{' && value.back() == '}') {
+        Util::split(value.substr(1, value.size() - 2), ',', values,
+                    Util::SplitModeNormal);
+        return !values.empty();
+    }
+
+    size_t range = value.find("..");
+    if (range == string::npos)
+        return false;
+
+    string rest = value.substr(range + 2);
+    size_t op = rest.find_first_of("/*");
+    char step_type = op == string::npos ? '/' : rest[op];
+    double start;
+    double end;
+    double step = 1.0;
+
+    if (!parse_sweep_number(value.substr(0, range), start) ||
+        !parse_sweep_number(rest.substr(0, op), end) ||
+        (op != string::npos && !parse_sweep_number(rest.substr(op + 1), step)) ||
+        end < start ||
+        (step_type == '/' && step <= 0.0) ||
+        (step_type == '*' && (step <= 1.0 || start <= 0.0)))
+    {
+        return false;
+    }
+
+    /* Allow for rounding errors when checking whether the end is reached */
+    double limit = end + 1e-9 * std::max(1.0, std::fabs(end));
+
+    for (unsigned int i = 0; values.size() <= max_values; i++) {
+        double d = step_type == '/' ? start + i * step : start * std::pow(step, i);
+        if (d > limit)
+            break;
+        values.push_back(format_sweep_number(d));
+    }
+
+    if (values.size() > max_values) {
+        Log::info("Warning: sweep '%s' has more than %u values\n",
+                  value.c_str(), static_cast<unsigned>(max_values));
+        return false;
+    }
+
+    return true;
+}
+
+vector<Benchmark *>
+Benchmark::create_from_description(const string &s)
+{
+    vector<Benchmark *> benchmarks;
+    vector<string> elems;
+    vector<OptionPair> options;
+    vector<vector<string> > sweep_values;
+    auto sweep = std::make_shared<Sweep>();
+
+    Util::split(s, ':', elems, Util::SplitModeNormal);
+
+    /* Descriptions without a scene set option defaults, which can't be swept */
+    if (elems.empty() || elems[0].empty()) {
+        benchmarks.push_back(new Benchmark(s));
+        return benchmarks;
+    }
+
+    for (vector<string>::const_iterator iter = elems.begin() + 1;
+         iter != elems.end();
+         iter++)
+    {
+        vector<string> opt;
+        vector<string> values;
+
+        Util::split(*iter, '=', opt, Util::SplitModeNormal);
+        if (opt.size() != 2 || !expand_sweep_value(opt[1], values))
+            continue;
+
+        options.push_back(OptionPair(opt[0], opt[1]));
+        sweep->options.push_back(opt[0]);
+        sweep_values.push_back(values);
+    }
+
+    /* Without sweeps, the description is handled as before */
+    if (sweep->options.empty()) {
+        benchmarks.push_back(new Benchmark(s));
+        return benchmarks;
+    }
+
+    sweep->description = s;
+
+    /* Create a benchmark for each combination of values, the last option changing fastest */
+    vector<size_t> indices(sweep_values.size(), 0);
+
+    while (true) {
+        Benchmark *benchmark = new Benchmark(s);
+
+        for (auto &opt : benchmark->options_) {
+            for (size_t i = 0; i < sweep->options.size(); i++) {
+                if (opt.first == sweep->options[i] && opt.second == options[i].second)
+                    opt.second = sweep_values[i][indices[i]];
+            }
+        }
+        benchmark->sweep_ = sweep;
+        benchmarks.push_back(benchmark);
+
+        size_t i = indices.size();
+        while (i > 0 && ++indices[i - 1] == sweep_values[i - 1].size())
+            indices[--i] = 0;
+        if (i == 0)
+            break;
+    }
+
+    return benchmarks;
+}
+
 void
 Benchmark::register_scene(Scene &scene)
 {
@@ -113,9 +271,20 @@ Benchmark::setup_scene()
 }
 
 void
-Benchmark::teardown_scene()
+Benchmark::teardown_scene(bool keep_loaded)
+{
+    scene_.finish(keep_loaded);
+}
+
+void
+Benchmark::prefetch_assets()
 {
-    scene_.finish();
+    map<string, string> options(options_.begin(), options_.end());
+    Scene::Assets assets;
+
+    scene_.assets(options, assets);
+    Model::prefetch(assets.models);
+    Texture::prefetch(assets.textures);
 }
 
 bool
@@ -25,6 +25,7 @@
 #include <vector>
 #include <string>
 #include <map>
+#include <memory>
 
 #include "scene.h"
 
@@ -38,6 +39,16 @@ class Benchmark
 public:
     typedef std::pair<std::string, std::string> OptionPair;
 
+    /**
+     * A sweep of option values that a benchmark is part of.
+     */
+    struct Sweep {
+        /** The description string containing the sweep */
+        std::string description;
+        /** The names of the swept options */
+        std::vector<std::string> options;
+    };
+
     /**
      * Creates a benchmark using a scene object reference.
      *
@@ -68,6 +79,25 @@ public:
      */
     Benchmark(const std::string &s);
 
+    /**
+     * Creates the benchmarks of a description string.
+     *
+     * Option values in the description string may be sweeps, which expand
+     * to multiple values:
+     *
+     *   {v1,v2,...}  a list of values
+     *   a..b         the integers from a to b
+     *   a..b/s       the values from a to b in steps of s
+     *   a..b*f       the values from a to b, multiplying by f in each step
+     *
+     * A benchmark is created for each combination of the swept values.
+     *
+     * @param s a description string
+     *
+     * @return the benchmarks, which must be deleted by the caller
+     */
+    static std::vector<Benchmark *> create_from_description(const std::string &s);
+
     /**
      * Gets the Scene associated with the benchmark.
      *
@@ -87,14 +117,35 @@ public:
 
     /**
      * Tears down the Scene associated with the benchmark.
+     *
+     * @param keep_loaded whether to keep the scene resources loaded, because
+     *        the next benchmark uses the same scene
+     */
+    void teardown_scene(bool keep_loaded = false);
+
+    /**
+     * Starts loading the assets of the Scene for the benchmark options in
+     * the background (see AssetPrefetcher).
      */
-    void teardown_scene();
+    void prefetch_assets();
 
     /**
      * Whether the benchmark needs extra decoration.
      */
     bool needs_decoration() const;
 
+    /**
+     * Gets the options of the benchmark.
+     */
+    const std::vector<OptionPair> &options() const { return options_; }
+
+    /**
+     * Gets the sweep the benchmark is part of.
+     *
+     * @return the sweep, or nullptr if the benchmark isn't part of a sweep
+     */
+    const std::shared_ptr<const Sweep> &sweep() const { return sweep_; }
+
     /**
      * Registers a Scene, so that it becomes accessible by name.
      */
@@ -117,6 +168,7 @@ public:
 private:
     Scene &scene_;
     std::vector<OptionPair> options_;
+    std::shared_ptr<const Sweep> sweep_;
 
     void load_options();
 
@@ -240,4 +240,6 @@ CanvasAndroid::init_gl_extensions()
     GLExtensions::RenderbufferStorage = glRenderbufferStorage;
 
     GLExtensions::GenerateMipmap = glGenerateMipmap;
+
+    GLExtensions::load_optional(load_proc, &gles_lib_);
 }
@@ -107,6 +107,8 @@ void
 CanvasGeneric::update()
 {
     Options::FrameEnd m = Options::frame_end;
+    /* Creating the sync flushes the frame, so it is part of frame_end */
+    uint64_t start = Util::get_timestamp_us();
 
     if (m == Options::FrameEndDefault) {
         if (offscreen_) {
@@ -123,9 +125,12 @@ CanvasGeneric::update()
             m = Options::FrameEndSwap;
     }
 
+    uint64_t flip_start = 0;
+
     switch(m) {
         case Options::FrameEndSwap:
             gl_state_.swap();
+            flip_start = Util::get_timestamp_us();
             native_state_.flip();
             break;
         case Options::FrameEndFinish:
@@ -139,11 +144,19 @@ CanvasGeneric::update()
             break;
     }
 
+    uint64_t end = Util::get_timestamp_us();
+    if (!flip_start)
+        flip_start = end;
+    update_times_.frame_end = (flip_start - start) / 1000000.0;
+    update_times_.flip = (end - flip_start) / 1000000.0;
+    update_times_.sync_wait = 0.0;
+
     if (offscreen_) {
         current_fbo_index_ = (current_fbo_index_ + 1) % fbos_.size();
         if (fbo_syncs_[current_fbo_index_]) {
             fbo_syncs_[current_fbo_index_]->wait();
             fbo_syncs_[current_fbo_index_].reset();
+            update_times_.sync_wait = (Util::get_timestamp_us() - end) / 1000000.0;
         }
         GLExtensions::BindFramebuffer(GL_FRAMEBUFFER, fbos_[current_fbo_index_].fbo);
     }
@@ -87,6 +87,20 @@ public:
         uint8_t a;
     };
 
+    /**
+     * The time (in seconds) spent in the parts of the last update() call
+     * that may block.
+     */
+    struct UpdateTimes {
+        UpdateTimes() :
+            frame_end(0.0), flip(0.0), sync_wait(0.0) {}
+        /** Ending the frame (swapping buffers, glFinish() or reading pixels) */
+        double frame_end;
+        /** Presenting the frame with the native window system */
+        double flip;
+        /** Waiting for the GPU to release the next off-screen buffer */
+        double sync_wait;
+    };
 
     /**
      * Initializes the canvas and makes it the target of GL operations.
@@ -247,6 +261,15 @@ public:
      */
     void visual_config(GLVisualConfig &config) { visual_config_ = config; }
 
+    /**
+     * Gets the time spent in the parts of the last update() call.
+     *
+     * Canvases that don't measure some of the parts report 0 for them.
+     *
+     * @return the update times
+     */
+    const UpdateTimes &update_times() { return update_times_; }
+
 protected:
     Canvas(int width, int height) :
         width_(width), height_(height), offscreen_(0) {}
@@ -256,6 +279,7 @@ protected:
     LibMatrix::mat4 projection_;
     unsigned int offscreen_;
     GLVisualConfig visual_config_;
+    UpdateTimes update_times_;
 };
 
 #endif
@@ -0,0 +1,388 @@
+/*
+ * Copyright © 2026 Collabora Limited
+ *
+ * This file is part of the glmark2 OpenGL (ES) 2.0 benchmark.
+ *
+ * glmark2 is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * glmark2 is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * glmark2.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "frame-log.h"
+#include "log.h"
+#include "results-file.h"
+#include "util.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#if !defined(_WIN32)
+#include <sys/mman.h>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+
+const char frame_log_magic[8] = {'G', 'L', 'M', '2', 'F', 'L', 'O', 'G'};
+const uint32_t frame_log_version = 1;
+const uint32_t frame_log_header_size = 32;
+const uint64_t record_end = 0;
+const uint64_t record_benchmark = 2;
+
+/* The file is extended in steps of this size */
+const size_t frame_log_chunk_size = 16 * 1024 * 1024;
+/* The largest frame record: a 64-bit varint */
+const size_t frame_log_max_frame_size = 10;
+
+int log_fd = -1;
+uint8_t *log_data = nullptr;
+size_t log_capacity = 0;
+size_t log_size = 0;
+uint64_t log_start = 0;
+uint64_t last_frame_end = 0;
+int64_t last_interval = 0;
+
+void
+put_u32(uint8_t *p, uint32_t v)
+{
+    for (int i = 0; i < 4; i++)
+        p[i] = static_cast<uint8_t>(v >> (8 * i));
+}
+
+void
+put_u64(uint8_t *p, uint64_t v)
+{
+    for (int i = 0; i < 8; i++)
+        p[i] = static_cast<uint8_t>(v >> (8 * i));
+}
+
+uint32_t
+get_u32(const uint8_t *p)
+{
+    uint32_t v = 0;
+    for (int i = 0; i < 4; i++)
+        v |= static_cast<uint32_t>(p[i]) << (8 * i);
+    return v;
+}
+
+uint64_t
+get_u64(const uint8_t *p)
+{
+    uint64_t v = 0;
+    for (int i = 0; i < 8; i++)
+        v |= static_cast<uint64_t>(p[i]) << (8 * i);
+    return v;
+}
+
+uint64_t
+zigzag_encode(int64_t v)
+{
+    return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63);
+}
+
+int64_t
+zigzag_decode(uint64_t v)
+{
+    return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1);
+}
+
+inline void
+put_varint(uint64_t v)
+{
+    while (v >= 0x80) {
+        log_data[log_size++] = static_cast<uint8_t>(v | 0x80);
+        v >>= 7;
+    }
+    log_data[log_size++] = static_cast<uint8_t>(v);
+}
+
+#if !defined(_WIN32)
+/* Makes sure there are at least size free bytes in the mapping */
+bool
+reserve(size_t size)
+{
+    if (log_size + size <= log_capacity)
+        return true;
+
+    size_t capacity = log_capacity + frame_log_chunk_size;
+    while (log_size + size > capacity)
+        capacity += frame_log_chunk_size;
+
+    if (log_data)
+        munmap(log_data, log_capacity);
+    log_data = nullptr;
+
+    if (ftruncate(log_fd, capacity) < 0) {
+        Log::error("Failed to extend frame log: %s\n", strerror(errno));
+        return false;
+    }
+
+    void *data = mmap(nullptr, capacity, PROT_READ | PROT_WRITE, MAP_SHARED, log_fd, 0);
+    if (data == MAP_FAILED) {
+        Log::error("Failed to map frame log: %s\n", strerror(errno));
+        return false;
+    }
+
+    log_data = static_cast<uint8_t *>(data);
+    log_capacity = capacity;
+
+    return true;
+}
+#endif
+
+/* Reads an unsigned LEB128 varint, returning false at the end of the input */
+bool
+read_varint(std::streambuf &sb, uint64_t &v)
+{
+    v = 0;
+
+    for (int shift = 0; shift < 64; shift += 7) {
+        int c = sb.sbumpc();
+        if (c == std::char_traits<char>::eof())
+            return false;
+        v |= static_cast<uint64_t>(c & 0x7f) << shift;
+        if (!(c & 0x80))
+            return true;
+    }
+
+    return false;
+}
+
+std::string
+csv_escape(const std::string &str)
+{
+    std::string escaped;
+
+    for (auto c : str) {
+        if (c == '"')
+            escaped += '"';
+        escaped += c;
+    }
+
+    return "\"" + escaped + "\"";
+}
+
+}
+
+bool FrameLog::enabled_ = false;
+
+bool
+FrameLog::init(const std::string &file)
+{
+    if (file.empty())
+        return true;
+
+#if !defined(_WIN32)
+    log_fd = open(file.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (log_fd < 0) {
+        Log::error("Failed to open frame log %s: %s\n", file.c_str(), strerror(errno));
+        return false;
+    }
+
+    if (!reserve(frame_log_header_size))
+        return false;
+
+    uint64_t wall_clock = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    log_start = Util::get_timestamp_us();
+
+    memcpy(log_data, frame_log_magic, sizeof(frame_log_magic));
+    put_u32(log_data + 8, frame_log_version);
+    put_u32(log_data + 12, frame_log_header_size);
+    put_u64(log_data + 16, wall_clock);
+    put_u64(log_data + 24, log_start);
+    log_size = frame_log_header_size;
+
+    enabled_ = true;
+
+    return true;
+#else
+    Log::error("Frame logs are not supported on this platform\n");
+    return false;
+#endif
+}
+
+void
+FrameLog::begin_benchmark(const std::string &name, uint64_t start)
+{
+#if !defined(_WIN32)
+    /* Benchmarks start outside of time-critical code, so grow the log here */
+    if (!reserve(name.size() + 3 * frame_log_max_frame_size + frame_log_chunk_size / 2)) {
+        enabled_ = false;
+        return;
+    }
+
+    put_varint(record_benchmark);
+    put_varint(name.size());
+    memcpy(log_data + log_size, name.data(), name.size());
+    log_size += name.size();
+    put_varint(start - log_start);
+
+    last_frame_end = start;
+    last_interval = 0;
+#else
+    static_cast<void>(name);
+    static_cast<void>(start);
+#endif
+}
+
+void
+FrameLog::add_frame(uint64_t end)
+{
+#if !defined(_WIN32)
+    if (log_size + frame_log_max_frame_size > log_capacity &&
+        !reserve(frame_log_max_frame_size))
+    {
+        enabled_ = false;
+        return;
+    }
+
+    int64_t interval = end - last_frame_end;
+
+    put_varint((zigzag_encode(interval - last_interval) << 1) | 1);
+
+    last_frame_end = end;
+    last_interval = interval;
+#else
+    static_cast<void>(end);
+#endif
+}
+
+void
+FrameLog::finish()
+{
+#if !defined(_WIN32)
+    if (log_fd < 0)
+        return;
+
+    if (log_data)
+        munmap(log_data, log_capacity);
+    if (ftruncate(log_fd, log_size) < 0)
+        Log::error("Failed to truncate frame log: %s\n", strerror(errno));
+    close(log_fd);
+
+    log_fd = -1;
+    log_data = nullptr;
+    enabled_ = false;
+#endif
+}
+
+bool
+FrameLog::dump(const std::string &file, Format format)
+{
+    std::ifstream ifs(file, std::ios::binary);
+    uint8_t header[frame_log_header_size];
+
+    if (!ifs) {
+        Log::error("Failed to open frame log %s\n", file.c_str());
+        return false;
+    }
+
+    if (!ifs.read(reinterpret_cast<char *>(header), sizeof(header)) ||
+        memcmp(header, frame_log_magic, sizeof(frame_log_magic)) != 0 ||
+        get_u32(header + 8) != frame_log_version)
+    {
+        Log::error("%s is not a supported frame log\n", file.c_str());
+        return false;
+    }
+
+    /* Skip any header fields added by later versions */
+    ifs.seekg(get_u32(header + 12));
+
+    uint64_t wall_clock = get_u64(header + 16);
+    std::streambuf &sb = *ifs.rdbuf();
+    std::string name;
+    uint64_t frame_end = 0;
+    int64_t interval = 0;
+    uint64_t frame = 0;
+    bool in_benchmark = false;
+    bool first_benchmark = true;
+    uint64_t v;
+
+    if (format == FormatCSV)
+        printf("benchmark,frame,timestamp,frame_time\n");
+    else
+        printf("{\n  \"start\": %.6f,\n  \"benchmarks\": [", wall_clock / 1000000.0);
+
+    while (read_varint(sb, v) && v != record_end) {
+        if (v & 1) {
+            if (!in_benchmark) {
+                Log::error("Frame outside of a benchmark in %s\n", file.c_str());
+                return false;
+            }
+
+            interval += zigzag_decode(v >> 1);
+            frame_end += interval;
+            frame++;
+
+            /* Timestamps are wall clock seconds, frame times milliseconds */
+            double timestamp = (wall_clock + frame_end) / 1000000.0;
+            if (format == FormatCSV) {
+                printf("%s,%llu,%.6f,%.3f\n", name.c_str(),
+                       static_cast<unsigned long long>(frame), timestamp, interval / 1000.0);
+            }
+            else {
+                printf("%s\n        [%.6f, %.3f]", frame > 1 ? "," : "",
+                       timestamp, interval / 1000.0);
+            }
+        }
+        else if (v == record_benchmark) {
+            uint64_t length;
+            uint64_t start;
+
+            if (!read_varint(sb, length) || length > 65536) {
+                Log::error("Invalid benchmark record in %s\n", file.c_str());
+                return false;
+            }
+
+            std::string raw(length, '\0');
+            if (sb.sgetn(&raw[0], length) != static_cast<std::streamsize>(length) ||
+                !read_varint(sb, start))
+            {
+                Log::error("Invalid benchmark record in %s\n", file.c_str());
+                return false;
+            }
+
+            if (format == FormatJSON) {
+                if (in_benchmark)
+                    printf("\n      ]\n    }");
+                printf("%s\n    {\n      \"name\": \"%s\",\n      \"start\": %.6f,\n"
+                       "      \"frames\": [", first_benchmark ? "" : ",",
+                       ResultsFile::json_escape(raw).c_str(), (wall_clock + start) / 1000000.0);
+            }
+
+            name = format == FormatCSV ? csv_escape(raw) : raw;
+            frame_end = start;
+            interval = 0;
+            frame = 0;
+            in_benchmark = true;
+            first_benchmark = false;
+        }
+        else {
+            Log::error("Unknown record type %llu in %s\n",
+                       static_cast<unsigned long long>(v), file.c_str());
+            return false;
+        }
+    }
+
+    if (format == FormatJSON) {
+        if (in_benchmark)
+            printf("\n      ]\n    }");
+        printf("\n  ]\n}\n");
+    }
+
+    return true;
+}
@@ -0,0 +1,112 @@
+/*
+ * Copyright © 2026 Collabora Limited
+ *
+ * This file is part of the glmark2 OpenGL (ES) 2.0 benchmark.
+ *
+ * glmark2 is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * glmark2 is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * glmark2.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef GLMARK2_FRAME_LOG_H_
+#define GLMARK2_FRAME_LOG_H_
+
+#include <string>
+#include <stdint.h>
+
+/**
+ * A compact, append-only binary log of the end time of every frame.
+ *
+ * The log starts with a fixed header:
+ *
+ *   magic          8 bytes  "GLM2FLOG"
+ *   version        uint32   1
+ *   header size    uint32   32
+ *   wall clock     uint64   the wall clock time of the start, in microseconds
+ *                           since the Unix epoch
+ *   monotonic      uint64   the Util::get_timestamp_us() time of the start
+ *
+ * followed by a sequence of unsigned LEB128 varints. Values with the lowest
+ * bit set are frames, other values are record types:
+ *
+ *   0              the end of the log (the file is zero-padded)
+ *   2 (benchmark)  followed by the name length, the name bytes and the start
+ *                  time of the benchmark in microseconds since the start of
+ *                  the log
+ *
+ * For frames, the remaining bits are the zigzag-encoded difference between
+ * the frame interval (the time since the end of the previous frame, or since
+ * the start of the benchmark) and the previous frame interval, in
+ * microseconds. At steady frame rates most frames take a single byte.
+ *
+ * Integers in the header are little-endian.
+ */
+class FrameLog
+{
+public:
+    enum Format {
+        FormatCSV,
+        FormatJSON
+    };
+
+    /**
+     * Starts logging frames.
+     *
+     * The log is written through a memory mapping of the file, which is
+     * extended in large steps, so logging a frame normally doesn't need any
+     * system calls.
+     *
+     * @param file the file to log to, or an empty string to disable logging
+     *
+     * @return whether the operation succeeded
+     */
+    static bool init(const std::string &file);
+
+    /**
+     * Whether logging is enabled.
+     */
+    static bool enabled() { return enabled_; }
+
+    /**
+     * Starts a benchmark.
+     *
+     * @param name the benchmark name, as returned by Scene::info_string()
+     * @param start the Util::get_timestamp_us() time of the start
+     */
+    static void begin_benchmark(const std::string &name, uint64_t start);
+
+    /**
+     * Logs a frame of the current benchmark.
+     *
+     * @param end the Util::get_timestamp_us() time of the end of the frame
+     */
+    static void add_frame(uint64_t end);
+
+    /**
+     * Truncates the file to the logged data and stops logging.
+     */
+    static void finish();
+
+    /**
+     * Converts a log to a text format, writing it to stdout.
+     *
+     * @param file the log file to read
+     * @param format the output format
+     *
+     * @return whether the operation succeeded
+     */
+    static bool dump(const std::string &file, Format format);
+
+private:
+    static bool enabled_;
+};
+
+#endif /* GLMARK2_FRAME_LOG_H_ */
@@ -21,6 +21,9 @@
  */
 #include "gl-headers.h"
 
+#include <cctype>
+#include <cstdio>
+
 void* (GLAD_API_PTR *GLExtensions::MapBuffer) (GLenum target, GLenum access) = 0;
 GLboolean (GLAD_API_PTR *GLExtensions::UnmapBuffer) (GLenum target) = 0;
 
@@ -38,6 +41,25 @@ void (GLAD_API_PTR *GLExtensions::RenderbufferStorage)(GLenum target, GLenum int
 
 void (GLAD_API_PTR *GLExtensions::GenerateMipmap)(GLenum target) = 0;
 
+void (GLAD_API_PTR *GLExtensions::GenQueries)(GLsizei n, GLuint *ids) = 0;
+void (GLAD_API_PTR *GLExtensions::DeleteQueries)(GLsizei n, const GLuint *ids) = 0;
+void (GLAD_API_PTR *GLExtensions::BeginQuery)(GLenum target, GLuint id) = 0;
+void (GLAD_API_PTR *GLExtensions::EndQuery)(GLenum target) = 0;
+void (GLAD_API_PTR *GLExtensions::GetQueryObjectuiv)(GLuint id, GLenum pname, GLuint *params) = 0;
+void (GLAD_API_PTR *GLExtensions::GetQueryObjectui64v)(GLuint id, GLenum pname, uint64_t *params) = 0;
+
+void (GLAD_API_PTR *GLExtensions::GetProgramBinary)(GLuint program, GLsizei bufSize, GLsizei *length, GLenum *binaryFormat, void *binary) = 0;
+void (GLAD_API_PTR *GLExtensions::ProgramBinary)(GLuint program, GLenum binaryFormat, const void *binary, GLsizei length) = 0;
+void (GLAD_API_PTR *GLExtensions::ProgramParameteri)(GLuint program, GLenum pname, GLint value) = 0;
+
+void (GLAD_API_PTR *GLExtensions::MaxShaderCompilerThreads)(GLuint count) = 0;
+void (GLAD_API_PTR *GLExtensions::GenVertexArrays)(GLsizei n, GLuint *arrays) = 0;
+void (GLAD_API_PTR *GLExtensions::DeleteVertexArrays)(GLsizei n, const GLuint *arrays) = 0;
+void (GLAD_API_PTR *GLExtensions::BindVertexArray)(GLuint array) = 0;
+
+GLenum GLExtensions::HalfFloatVertexType = 0;
+bool GLExtensions::VertexType2101010Rev = false;
+
 bool
 GLExtensions::support(const std::string &ext)
 {
@@ -58,3 +80,141 @@ GLExtensions::support(const std::string &ext)
 
     return pos != std::string::npos;
 }
+
+/*
+ * Gets the version of the current context as 10 * major + minor, for both
+ * GL and GLES version strings.
+ */
+static int
+gl_version()
+{
+    const char *version = reinterpret_cast<const char *>(glGetString(GL_VERSION));
+    if (!version)
+        return 0;
+
+    /* GLES version strings start with "OpenGL ES " */
+    while (*version && !isdigit(*version))
+        version++;
+
+    int major = 0;
+    int minor = 0;
+    sscanf(version, "%d.%d", &major, &minor);
+
+    return 10 * major + minor;
+}
+
+/*
+ * Looks up an entry point and casts it to the type of the supplied
+ * function pointer.
+ */
+template<typename T> static void
+load_entry_point(T &func, GLADuserptrloadfunc load_proc, void *userptr,
+                 const char *name)
+{
+    func = reinterpret_cast<T>(load_proc(userptr, name));
+}
+
+void
+GLExtensions::load_optional(GLADuserptrloadfunc load_proc, void *userptr)
+{
+#if GLMARK2_USE_GLESv2
+    bool timer_query = support("GL_EXT_disjoint_timer_query");
+    std::string query_suffix("EXT");
+    std::string query64_suffix("EXT");
+    bool program_binary = support("GL_OES_get_program_binary");
+    std::string program_binary_suffix("OES");
+    bool parallel_compile = support("GL_KHR_parallel_shader_compile");
+    std::string parallel_compile_suffix("KHR");
+    bool gles3 = gl_version() >= 30;
+    bool vertex_array = gles3 || support("GL_OES_vertex_array_object");
+    std::string vertex_array_suffix(gles3 ? "" : "OES");
+
+    if (gles3)
+        HalfFloatVertexType = GL_HALF_FLOAT;
+    else if (support("GL_OES_vertex_half_float"))
+        HalfFloatVertexType = GL_HALF_FLOAT_OES;
+    else
+        HalfFloatVertexType = 0;
+    VertexType2101010Rev = gles3;
+#elif GLMARK2_USE_GL
+    bool timer_query_arb = support("GL_ARB_timer_query");
+    bool timer_query = timer_query_arb || support("GL_EXT_timer_query");
+    std::string query_suffix("");
+    std::string query64_suffix(timer_query_arb ? "" : "EXT");
+    bool program_binary = support("GL_ARB_get_program_binary");
+    std::string program_binary_suffix("");
+    bool parallel_compile_khr = support("GL_KHR_parallel_shader_compile");
+    bool parallel_compile = parallel_compile_khr || support("GL_ARB_parallel_shader_compile");
+    std::string parallel_compile_suffix(parallel_compile_khr ? "KHR" : "ARB");
+    int version = gl_version();
+    bool vertex_array = version >= 30 || support("GL_ARB_vertex_array_object");
+    std::string vertex_array_suffix("");
+
+    if (version >= 30 || support("GL_ARB_half_float_vertex"))
+        HalfFloatVertexType = GL_HALF_FLOAT;
+    else
+        HalfFloatVertexType = 0;
+    VertexType2101010Rev = version >= 33 || support("GL_ARB_vertex_type_2_10_10_10_rev");
+#endif
+
+    GenQueries = 0;
+    DeleteQueries = 0;
+    BeginQuery = 0;
+    EndQuery = 0;
+    GetQueryObjectuiv = 0;
+    GetQueryObjectui64v = 0;
+
+    if (timer_query) {
+        load_entry_point(GenQueries, load_proc, userptr,
+                         ("glGenQueries" + query_suffix).c_str());
+        load_entry_point(DeleteQueries, load_proc, userptr,
+                         ("glDeleteQueries" + query_suffix).c_str());
+        load_entry_point(BeginQuery, load_proc, userptr,
+                         ("glBeginQuery" + query_suffix).c_str());
+        load_entry_point(EndQuery, load_proc, userptr,
+                         ("glEndQuery" + query_suffix).c_str());
+        load_entry_point(GetQueryObjectuiv, load_proc, userptr,
+                         ("glGetQueryObjectuiv" + query_suffix).c_str());
+        load_entry_point(GetQueryObjectui64v, load_proc, userptr,
+                         ("glGetQueryObjectui64v" + query64_suffix).c_str());
+    }
+
+    GetProgramBinary = 0;
+    ProgramBinary = 0;
+    ProgramParameteri = 0;
+
+    /* Drivers may expose the extension without supporting any formats */
+    GLint program_binary_formats = 0;
+    if (program_binary)
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &program_binary_formats);
+
+    if (program_binary_formats > 0) {
+        load_entry_point(GetProgramBinary, load_proc, userptr,
+                         ("glGetProgramBinary" + program_binary_suffix).c_str());
+        load_entry_point(ProgramBinary, load_proc, userptr,
+                         ("glProgramBinary" + program_binary_suffix).c_str());
+#if GLMARK2_USE_GL
+        load_entry_point(ProgramParameteri, load_proc, userptr, "glProgramParameteri");
+#endif
+    }
+
+    MaxShaderCompilerThreads = 0;
+
+    if (parallel_compile) {
+        load_entry_point(MaxShaderCompilerThreads, load_proc, userptr,
+                         ("glMaxShaderCompilerThreads" + parallel_compile_suffix).c_str());
+    }
+
+    GenVertexArrays = 0;
+    DeleteVertexArrays = 0;
+    BindVertexArray = 0;
+
+    if (vertex_array) {
+        load_entry_point(GenVertexArrays, load_proc, userptr,
+                         ("glGenVertexArrays" + vertex_array_suffix).c_str());
+        load_entry_point(DeleteVertexArrays, load_proc, userptr,
+                         ("glDeleteVertexArrays" + vertex_array_suffix).c_str());
+        load_entry_point(BindVertexArray, load_proc, userptr,
+                         ("glBindVertexArray" + vertex_array_suffix).c_str());
+    }
+}
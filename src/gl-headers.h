@@ -67,6 +67,46 @@
 #ifndef GL_GENERATE_MIPMAP
 #define GL_GENERATE_MIPMAP 0x8191
 #endif
+#ifndef GL_QUERY_RESULT
+#define GL_QUERY_RESULT 0x8866
+#endif
+#ifndef GL_QUERY_RESULT_AVAILABLE
+#define GL_QUERY_RESULT_AVAILABLE 0x8867
+#endif
+#endif
+
+#ifndef GL_TIME_ELAPSED
+#define GL_TIME_ELAPSED 0x88BF
+#endif
+#ifndef GL_GPU_DISJOINT_EXT
+#define GL_GPU_DISJOINT_EXT 0x8FBB
+#endif
+#ifndef GL_GPU_MEMORY_INFO_CURRENT_AVAILABLE_VIDMEM_NVX
+#define GL_GPU_MEMORY_INFO_CURRENT_AVAILABLE_VIDMEM_NVX 0x9049
+#endif
+#ifndef GL_TEXTURE_FREE_MEMORY_ATI
+#define GL_TEXTURE_FREE_MEMORY_ATI 0x87FC
+#endif
+#ifndef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#endif
+#ifndef GL_PROGRAM_BINARY_LENGTH
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#endif
+#ifndef GL_NUM_PROGRAM_BINARY_FORMATS
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#endif
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+#ifndef GL_HALF_FLOAT
+#define GL_HALF_FLOAT 0x140B
+#endif
+#ifndef GL_HALF_FLOAT_OES
+#define GL_HALF_FLOAT_OES 0x8D61
+#endif
+#ifndef GL_INT_2_10_10_10_REV
+#define GL_INT_2_10_10_10_REV 0x8D9F
 #endif
 
 #include <string>
@@ -83,6 +123,16 @@ struct GLExtensions {
      */
     static bool support(const std::string &ext);
 
+    /**
+     * Loads the entry points and properties of optional extensions
+     * supported by the current context. Entry points of unsupported
+     * extensions are set to 0.
+     *
+     * @param load_proc the function to use to look up entry points
+     * @param userptr the user data to pass to load_proc
+     */
+    static void load_optional(GLADuserptrloadfunc load_proc, void *userptr);
+
     static void* (GLAD_API_PTR *MapBuffer) (GLenum target, GLenum access);
     static GLboolean (GLAD_API_PTR *UnmapBuffer) (GLenum target);
 
@@ -99,6 +149,38 @@ struct GLExtensions {
     static void (GLAD_API_PTR *RenderbufferStorage)(GLenum target, GLenum internalformat, GLsizei width, GLsizei height);
 
     static void (GLAD_API_PTR *GenerateMipmap)(GLenum target);
+
+    /* GL_ARB_timer_query, GL_EXT_timer_query, GL_EXT_disjoint_timer_query */
+    static void (GLAD_API_PTR *GenQueries)(GLsizei n, GLuint *ids);
+    static void (GLAD_API_PTR *DeleteQueries)(GLsizei n, const GLuint *ids);
+    static void (GLAD_API_PTR *BeginQuery)(GLenum target, GLuint id);
+    static void (GLAD_API_PTR *EndQuery)(GLenum target);
+    static void (GLAD_API_PTR *GetQueryObjectuiv)(GLuint id, GLenum pname, GLuint *params);
+    static void (GLAD_API_PTR *GetQueryObjectui64v)(GLuint id, GLenum pname, uint64_t *params);
+
+    /* GL_ARB_get_program_binary, GL_OES_get_program_binary */
+    static void (GLAD_API_PTR *GetProgramBinary)(GLuint program, GLsizei bufSize, GLsizei *length, GLenum *binaryFormat, void *binary);
+    static void (GLAD_API_PTR *ProgramBinary)(GLuint program, GLenum binaryFormat, const void *binary, GLsizei length);
+    /* Only available with GL_ARB_get_program_binary */
+    static void (GLAD_API_PTR *ProgramParameteri)(GLuint program, GLenum pname, GLint value);
+
+    /* GL_KHR_parallel_shader_compile, GL_ARB_parallel_shader_compile */
+    static void (GLAD_API_PTR *MaxShaderCompilerThreads)(GLuint count);
+
+    /* GL 3.0, GLES 3.0, GL_ARB_vertex_array_object, GL_OES_vertex_array_object */
+    static void (GLAD_API_PTR *GenVertexArrays)(GLsizei n, GLuint *arrays);
+    static void (GLAD_API_PTR *DeleteVertexArrays)(GLsizei n, const GLuint *arrays);
+    static void (GLAD_API_PTR *BindVertexArray)(GLuint array);
+
+    /*
+     * The type of half float vertex attributes (GL 3.0, GLES 3.0,
+     * GL_ARB_half_float_vertex, GL_OES_vertex_half_float), or 0 if they
+     * are not supported
+     */
+    static GLenum HalfFloatVertexType;
+    /* Whether GL_INT_2_10_10_10_REV vertex attributes are supported (GL 3.3,
+     * GLES 3.0, GL_ARB_vertex_type_2_10_10_10_rev) */
+    static bool VertexType2101010Rev;
 };
 
 #endif
@@ -396,6 +396,9 @@ GLStateEGL::init_gl_extensions()
 
     GLExtensions::GenerateMipmap = glGenerateMipmapEXT;
 #endif
+
+    GLExtensions::load_optional(load_proc, &gl_lib_);
+
     return true;
 }
 
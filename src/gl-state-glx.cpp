@@ -78,6 +78,8 @@ GLStateGLX::init_gl_extensions()
 
     GLExtensions::GenerateMipmap = glGenerateMipmapEXT;
 
+    GLExtensions::load_optional(load_proc, this);
+
     return true;
 }
 
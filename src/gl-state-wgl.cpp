@@ -129,6 +129,8 @@ GLStateWGL::init_gl_extensions()
 
     GLExtensions::GenerateMipmap = glGenerateMipmapEXT;
 
+    GLExtensions::load_optional(load_proc, this);
+
     return true;
 }
 
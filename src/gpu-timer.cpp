@@ -0,0 +1,151 @@
+/*
+ * Copyright © 2026 Collabora Limited
+ *
+ * This file is part of the glmark2 OpenGL (ES) 2.0 benchmark.
+ *
+ * glmark2 is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * glmark2 is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * glmark2.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "gpu-timer.h"
+
+bool
+GPUTimer::supported()
+{
+    return GLExtensions::GenQueries && GLExtensions::DeleteQueries &&
+           GLExtensions::BeginQuery && GLExtensions::EndQuery &&
+           GLExtensions::GetQueryObjectuiv && GLExtensions::GetQueryObjectui64v;
+}
+
+bool
+GPUTimer::start(size_t expected_frames)
+{
+    frame_times_.clear();
+    disjoint_frames_ = 0;
+
+    if (!supported())
+        return false;
+
+    frame_times_.reserve(expected_frames);
+
+#if GLMARK2_USE_GLESv2
+    /* Clear any stale disjoint state before the first query */
+    GLint disjoint = 0;
+    glGetIntegerv(GL_GPU_DISJOINT_EXT, &disjoint);
+#endif
+
+    queries_.resize(initial_queries);
+    GLExtensions::GenQueries(queries_.size(), queries_.data());
+    free_ = queries_;
+    pending_.clear();
+    active_ = true;
+
+    current_ = free_query();
+    GLExtensions::BeginQuery(GL_TIME_ELAPSED, current_);
+
+    return true;
+}
+
+void
+GPUTimer::next_frame()
+{
+    if (!active_)
+        return;
+
+    GLExtensions::EndQuery(GL_TIME_ELAPSED);
+    pending_.push_back(current_);
+
+    current_ = free_query();
+    GLExtensions::BeginQuery(GL_TIME_ELAPSED, current_);
+}
+
+void
+GPUTimer::collect()
+{
+    if (!active_)
+        return;
+
+    collect(false);
+}
+
+void
+GPUTimer::stop()
+{
+    if (!active_)
+        return;
+
+    /*
+     * The last query only covers the work done after the final frame
+     * was updated, so its result is not collected.
+     */
+    GLExtensions::EndQuery(GL_TIME_ELAPSED);
+
+    collect(true);
+
+    GLExtensions::DeleteQueries(queries_.size(), queries_.data());
+    queries_.clear();
+    free_.clear();
+    active_ = false;
+}
+
+GLuint
+GPUTimer::free_query()
+{
+    /* Rather than waiting for a query to become free, create a new one */
+    if (free_.empty()) {
+        GLuint query;
+        GLExtensions::GenQueries(1, &query);
+        queries_.push_back(query);
+        return query;
+    }
+
+    GLuint query = free_.back();
+    free_.pop_back();
+    return query;
+}
+
+void
+GPUTimer::collect(bool wait)
+{
+    size_t first = frame_times_.size();
+
+    /* Results become available in the order the queries were issued */
+    while (!pending_.empty()) {
+        GLuint query = pending_.front();
+
+        if (!wait) {
+            GLuint available = 0;
+            GLExtensions::GetQueryObjectuiv(query, GL_QUERY_RESULT_AVAILABLE,
+                                            &available);
+            if (!available)
+                break;
+        }
+
+        uint64_t elapsed_ns = 0;
+        GLExtensions::GetQueryObjectui64v(query, GL_QUERY_RESULT, &elapsed_ns);
+        frame_times_.push_back(elapsed_ns / 1000000000.0);
+        pending_.pop_front();
+        free_.push_back(query);
+    }
+
+#if GLMARK2_USE_GLESv2
+    /* Results read while a disjoint event occurred are not reliable */
+    GLint disjoint = 0;
+    glGetIntegerv(GL_GPU_DISJOINT_EXT, &disjoint);
+    if (disjoint) {
+        disjoint_frames_ += frame_times_.size() - first;
+        frame_times_.resize(first);
+    }
+#else
+    static_cast<void>(first);
+#endif
+}
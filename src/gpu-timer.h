@@ -0,0 +1,105 @@
+/*
+ * Copyright © 2026 Collabora Limited
+ *
+ * This file is part of the glmark2 OpenGL (ES) 2.0 benchmark.
+ *
+ * glmark2 is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * glmark2 is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * glmark2.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef GLMARK2_GPU_TIMER_H_
+#define GLMARK2_GPU_TIMER_H_
+
+#include "gl-headers.h"
+
+#include <deque>
+#include <vector>
+
+/**
+ * Measures the GPU time spent on each frame using timer queries.
+ *
+ * The results of the queries are read back a few frames later, once they
+ * become available, so that measuring doesn't stall the GL pipeline. If all
+ * the queries are still in flight when a frame starts, a new query is
+ * created instead of waiting for one to become free.
+ */
+class GPUTimer
+{
+public:
+    GPUTimer() : active_(false), current_(0), disjoint_frames_(0) {}
+
+    /**
+     * Whether the current context supports timer queries.
+     */
+    static bool supported();
+
+    /**
+     * Starts timing, beginning the query for the first frame.
+     *
+     * @param expected_frames the number of frames to reserve room for
+     *
+     * @return whether timing was started
+     */
+    bool start(size_t expected_frames);
+
+    /**
+     * Ends the query for the current frame and begins the query for the
+     * next one.
+     */
+    void next_frame();
+
+    /**
+     * Collects the results of the pending queries that are available,
+     * without waiting for the others.
+     */
+    void collect();
+
+    /**
+     * Stops timing and collects the results of all pending queries.
+     */
+    void stop();
+
+    /**
+     * Whether timing is in progress.
+     */
+    bool active() { return active_; }
+
+    /**
+     * Gets the GPU time (in seconds) of each frame with a valid result.
+     */
+    const std::vector<double> &frame_times() { return frame_times_; }
+
+    /**
+     * Gets the number of frames whose results were discarded because
+     * of a GPU disjoint event.
+     */
+    unsigned int disjoint_frames() { return disjoint_frames_; }
+
+private:
+    void collect(bool wait);
+    GLuint free_query();
+
+    /* The number of queries to create up front */
+    static const unsigned int initial_queries = 8;
+
+    bool active_;
+    /* All the queries created, and the ones not in use */
+    std::vector<GLuint> queries_;
+    std::vector<GLuint> free_;
+    /* The query of the current frame, and those of previous frames in order */
+    GLuint current_;
+    std::deque<GLuint> pending_;
+    unsigned int disjoint_frames_;
+    std::vector<double> frame_times_;
+};
+
+#endif /* GLMARK2_GPU_TIMER_H_ */
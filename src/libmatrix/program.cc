@@ -209,12 +209,30 @@ Program::build()
     }
 
     glLinkProgram(handle_);
+    checkLinkStatus();
+}
+
+void
+Program::buildFromLinked()
+{
+    if (!valid_ || ready_)
+    {
+        return;
+    }
+
+    checkLinkStatus();
+}
+
+void
+Program::checkLinkStatus()
+{
     GLint param = 1;
     glGetProgramiv(handle_, GL_LINK_STATUS, &param);
     if (param == GL_FALSE)
     {
         glGetProgramiv(handle_, GL_INFO_LOG_LENGTH, &param);
         GLchar* infoLog = new GLchar[param + 1];
+        infoLog[0] = 0;
         glGetProgramInfoLog(handle_, param + 1, NULL, infoLog);
         message_ = infoLog;
         delete [] infoLog;
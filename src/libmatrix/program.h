@@ -107,6 +107,13 @@ public:
     // has been successfully added before calling this one.
     void build();
 
+    // Mark the program as built if it has been linked by other means than
+    // build() (e.g. by loading a program binary into handle()), checking
+    // the link status.
+    //
+    // Make sure the program is "valid" before calling this one.
+    void buildFromLinked();
+
     // Bind the program for use by the rendering context (i.e. actually
     // run it).
     //
@@ -159,7 +166,11 @@ private:
     bool ready() const { return ready_; }
     const std::string& errorMessage() const { return message_; }
 
+    // The handle of the underlying OpenGL program object.
+    unsigned int handle() const { return handle_; }
+
 private:
+    void checkLinkStatus();
     int getAttribIndex(const std::string& name);
     int getUniformLocation(const std::string& name);
     unsigned int handle_;
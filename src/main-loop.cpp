@@ -21,10 +21,20 @@
  */
 #include "options.h"
 #include "main-loop.h"
+#include "asset-prefetcher.h"
+#include "baseline.h"
+#include "frame-log.h"
+#include "metrics-exporter.h"
 #include "util.h"
 #include "log.h"
 #include "results-file.h"
+#include "statistics.h"
+#include "trace.h"
 
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <random>
 #include <string>
 #include <sstream>
 
@@ -35,6 +45,7 @@
 MainLoop::MainLoop(Canvas &canvas, const std::vector<Benchmark *> &benchmarks) :
     canvas_(canvas), benchmarks_(benchmarks)
 {
+    save_option_defaults();
     reset();
 }
 
@@ -44,9 +55,13 @@ MainLoop::reset()
 {
     scene_ = 0;
     scene_setup_status_ = SceneSetupStatusUnknown;
+    benchmark_start_ = 0;
     score_ = 0;
     benchmarks_run_ = 0;
-    bench_iter_ = benchmarks_.begin();
+    repeat_results_.clear();
+    restore_option_defaults();
+    build_run_order();
+    bench_iter_ = run_order_.begin();
 }
 
 unsigned int
@@ -64,7 +79,7 @@ MainLoop::step()
     /* Find the next normal scene */
     if (!scene_) {
         /* Find a normal scene */
-        while (bench_iter_ != benchmarks_.end()) {
+        while (bench_iter_ != run_order_.end()) {
             scene_ = &(*bench_iter_)->scene();
 
             /* 
@@ -80,7 +95,8 @@ MainLoop::step()
         }
 
         /* If we have found a valid scene, set it up */
-        if (bench_iter_ != benchmarks_.end()) {
+        if (bench_iter_ != run_order_.end()) {
+            benchmark_start_ = Util::get_timestamp_us();
             before_scene_setup();
             if (!Options::reuse_context)
                 canvas_.reset();
@@ -96,9 +112,27 @@ MainLoop::step()
             }
             after_scene_setup();
             log_scene_info();
+
+            if (MetricsExporter::enabled())
+                MetricsExporter::begin_benchmark(scene_->name(), scene_->info_string());
+            if (FrameLog::enabled())
+                FrameLog::begin_benchmark(scene_->info_string(), Util::get_timestamp_us());
+
+            /* Load the assets of the next benchmark while this one runs */
+            if (AssetPrefetcher::enabled()) {
+                Benchmark *next = next_scene_benchmark();
+                if (next)
+                    next->prefetch_assets();
+            }
         }
         else {
             /* ... otherwise we are done */
+            if (!repeat_results_.empty()) {
+                if (Options::repeat > 1)
+                    log_repeat_summary();
+                log_scaling_summary();
+                repeat_results_.clear();
+            }
             return false;
         }
     }
@@ -113,12 +147,33 @@ MainLoop::step()
      * in draw() may have changed the state.
      */
     if (!scene_->running() || should_quit) {
-        (*bench_iter_)->teardown_scene();
+        (*bench_iter_)->teardown_scene(Options::reuse_context && !should_quit &&
+                                       next_benchmark_uses_scene(*scene_));
         if (scene_setup_status_ == SceneSetupStatusSuccess) {
             score_ += scene_->average_fps();
             benchmarks_run_++;
+
+            if (Options::repeat > 1 || (*bench_iter_)->sweep()) {
+                double frame_time = scene_->stats().average_frame_time;
+
+                /* A run without any frames has no meaningful frame time */
+                if (frame_time > 0.0 && std::isfinite(frame_time)) {
+                    RepeatResults &results = repeat_results_[*bench_iter_];
+                    results.info_string = scene_->info_string();
+                    results.frame_times.push_back(frame_time);
+                    results.fps.push_back(1.0 / frame_time);
+                }
+            }
         }
         log_scene_result();
+
+        /* Write out the trace between benchmarks, where it can't affect them */
+        if (Trace::enabled()) {
+            Trace::add_span("benchmark", "benchmark", benchmark_start_,
+                            Util::get_timestamp_us(), scene_->info_string());
+            Trace::flush();
+        }
+
         scene_ = 0;
         next_benchmark();
     }
@@ -129,12 +184,22 @@ MainLoop::step()
 void
 MainLoop::draw()
 {
+    uint64_t clear_start = Util::get_timestamp_us();
     canvas_.clear();
 
+    uint64_t draw_start = Util::get_timestamp_us();
     scene_->draw();
+
+    uint64_t update_start = Util::get_timestamp_us();
     scene_->update();
+    uint64_t update_end = Util::get_timestamp_us();
 
     canvas_.update();
+
+    record_frame_phases(clear_start, draw_start, update_start, update_end,
+                        update_end);
+
+    scene_->collect_gpu_times();
 }
 
 void
@@ -148,6 +213,11 @@ MainLoop::log_scene_info()
     ResultsFile &results_file = ResultsFile::get();
     results_file.begin_benchmark();
     results_file.add_field("name", info_string);
+
+    std::map<std::string, std::string> options;
+    for (auto const& opt : scene_->options())
+        options[opt.first] = opt.second.value;
+    results_file.add_options(options);
 }
 
 void
@@ -159,8 +229,30 @@ MainLoop::log_scene_result()
                                           " FrameTime: %s ms");
     static const std::string format_cpu(Log::continuation_prefix +
                                         " (User: %s ms, System: %s ms) CpuBusy: %s%%");
+    static const std::string format_gpu(Log::continuation_prefix +
+                                        " GpuTime: %s ms");
     static const std::string format_shader(Log::continuation_prefix +
                                            " ShaderCompTime: %s ms");
+    static const std::string format_extra(Log::continuation_prefix + " %s: %s%s");
+    static const std::string format_frame_dist(Log::continuation_prefix +
+                                               " FrameTime(min/p50/p90/p95/p99/max): "
+                                               "%s/%s/%s/%s/%s/%s ms StdDev: %s ms");
+    static const std::string format_warmup(Log::continuation_prefix +
+                                           " Warmup: %u frames, FrameTime(avg/max): %s/%s ms");
+    static const std::string format_adaptive(Log::continuation_prefix +
+                                             " Adaptive: %s after %s s (CI95: +-%s%%)");
+    static const std::string format_perf(Log::continuation_prefix +
+                                         " Perf(per frame): Cycles: %s Instructions: %s IPC: %s"
+                                         " CacheMisses: %s BranchMisses: %s"
+                                         " ContextSwitches: %s PageFaults: %s TaskClock: %s ms");
+    static const std::string format_memory(Log::continuation_prefix +
+                                           " Memory(baseline/peak/final): RSS: %s/%s/%s KiB"
+                                           " PSS: %s/%s/%s KiB GL: %s/%s/%s KiB");
+    static const std::string format_baseline(Log::continuation_prefix +
+                                             " Baseline: %s -> %s ms (%s) %s");
+    static const std::string format_histogram_bucket("    %9.3f - %9.3f ms: %llu\n");
+    static const std::string format_phase_header("    %-10s %9s %9s %9s %9s\n");
+    static const std::string format_phase("    %-10s %9.3f %9.3f %9.3f %9.3f\n");
     static const std::string format_unsupported(Log::continuation_prefix +
                                                 " Unsupported\n");
     static const std::string format_fail(Log::continuation_prefix +
@@ -209,6 +301,15 @@ MainLoop::log_scene_result()
             results_file.add_field("cpu_busy", cpu_busy);
         }
 
+        if (Options::results & Options::ResultsGpu)
+        {
+            std::string gpu_time = scene_->gpu_frame_times().empty() ?
+                "n/a" : Util::toString(1000.0 * stats.average_gpu_time, 3);
+
+            Log::info(format_gpu.c_str(), gpu_time.c_str());
+            results_file.add_field("gpu_time", gpu_time);
+        }
+
         if (Options::results & Options::ResultsShader)
         {
             std::string shader_time =
@@ -218,32 +319,617 @@ MainLoop::log_scene_result()
             results_file.add_field("shader_comp_time", shader_time);
         }
 
+        for (auto const& result : scene_->extra_results()) {
+            std::string unit(result.unit.empty() ? "" : " " + result.unit);
+            Log::info(format_extra.c_str(), result.name.c_str(), result.value.c_str(),
+                      unit.c_str());
+            results_file.add_field(result.field, result.value);
+        }
+
+        if (Options::results & Options::ResultsFrameTime)
+        {
+            std::string min_time = Util::toString(1000.0 * stats.min_frame_time, 3);
+            std::string median_time = Util::toString(1000.0 * stats.median_frame_time, 3);
+            std::string p90_time = Util::toString(1000.0 * stats.p90_frame_time, 3);
+            std::string p95_time = Util::toString(1000.0 * stats.p95_frame_time, 3);
+            std::string p99_time = Util::toString(1000.0 * stats.p99_frame_time, 3);
+            std::string max_time = Util::toString(1000.0 * stats.max_frame_time, 3);
+            std::string stddev_time = Util::toString(1000.0 * stats.stddev_frame_time, 3);
+
+            Log::info(format_frame_dist.c_str(),
+                      min_time.c_str(), median_time.c_str(), p90_time.c_str(),
+                      p95_time.c_str(), p99_time.c_str(), max_time.c_str(),
+                      stddev_time.c_str());
+            results_file.add_field("frame_time_min", min_time);
+            results_file.add_field("frame_time_median", median_time);
+            results_file.add_field("frame_time_p90", p90_time);
+            results_file.add_field("frame_time_p95", p95_time);
+            results_file.add_field("frame_time_p99", p99_time);
+            results_file.add_field("frame_time_max", max_time);
+            results_file.add_field("frame_time_stddev", stddev_time);
+        }
+
+        if (Options::results & Options::ResultsPerf)
+        {
+            std::string perf[PerfCounters::CounterCount];
+
+            for (int i = 0; i < PerfCounters::CounterCount; i++) {
+                double value = stats.perf_per_frame[i];
+
+                if (!stats.perf_available[i])
+                    perf[i] = "n/a";
+                else if (i == PerfCounters::CounterTaskClock)
+                    perf[i] = Util::toString(value / 1000000.0, 3);
+                else
+                    perf[i] = Util::toString(value, 1);
+            }
+
+            std::string ipc = "n/a";
+            if (stats.perf_available[PerfCounters::CounterCycles] &&
+                stats.perf_available[PerfCounters::CounterInstructions] &&
+                stats.perf_per_frame[PerfCounters::CounterCycles] > 0.0)
+            {
+                ipc = Util::toString(stats.perf_per_frame[PerfCounters::CounterInstructions] /
+                                     stats.perf_per_frame[PerfCounters::CounterCycles], 3);
+            }
+
+            Log::info(format_perf.c_str(),
+                      perf[PerfCounters::CounterCycles].c_str(),
+                      perf[PerfCounters::CounterInstructions].c_str(),
+                      ipc.c_str(),
+                      perf[PerfCounters::CounterCacheMisses].c_str(),
+                      perf[PerfCounters::CounterBranchMisses].c_str(),
+                      perf[PerfCounters::CounterContextSwitches].c_str(),
+                      perf[PerfCounters::CounterPageFaults].c_str(),
+                      perf[PerfCounters::CounterTaskClock].c_str());
+
+            for (int i = 0; i < PerfCounters::CounterCount; i++) {
+                results_file.add_field(std::string("perf_") +
+                                       PerfCounters::name(static_cast<PerfCounters::Counter>(i)),
+                                       perf[i]);
+            }
+            results_file.add_field("perf_ipc", ipc);
+        }
+
+        if (Options::results & Options::ResultsMemory)
+        {
+            const MemorySample &baseline = stats.memory_baseline;
+            const MemorySample &peak = stats.memory_peak;
+            const MemorySample &final = stats.memory_final;
+            auto kib = [](int64_t v) { return v < 0 ? std::string("n/a") : Util::toString(v); };
+            /* GL memory is reported as the amount used since the baseline */
+            auto gl_used = [&baseline](int64_t available) {
+                return available < 0 || baseline.gl_available < 0 ?
+                    std::string("n/a") : Util::toString(baseline.gl_available - available);
+            };
+
+            std::string rss[3] = {kib(baseline.rss), kib(peak.rss), kib(final.rss)};
+            std::string pss[3] = {kib(baseline.pss), kib(peak.pss), kib(final.pss)};
+            std::string gl[3] = {kib(baseline.gl_available < 0 ? -1 : 0),
+                                 gl_used(peak.gl_available),
+                                 gl_used(final.gl_available)};
+
+            Log::info(format_memory.c_str(),
+                      rss[0].c_str(), rss[1].c_str(), rss[2].c_str(),
+                      pss[0].c_str(), pss[1].c_str(), pss[2].c_str(),
+                      gl[0].c_str(), gl[1].c_str(), gl[2].c_str());
+
+            static const char *points[3] = {"baseline", "peak", "final"};
+            for (int i = 0; i < 3; i++) {
+                results_file.add_field(std::string("memory_rss_") + points[i], rss[i]);
+                results_file.add_field(std::string("memory_pss_") + points[i], pss[i]);
+                results_file.add_field(std::string("memory_gl_") + points[i], gl[i]);
+            }
+        }
+
+        if (scene_->options().find("adaptive")->second.value == "true")
+        {
+            std::string converged = stats.converged ? "converged" : "not converged";
+            std::string run_time = Util::toString(stats.run_time, 3);
+            std::string ci95 = Util::toString(100.0 * stats.frame_time_ci95 /
+                                              stats.average_frame_time, 2);
+
+            Log::info(format_adaptive.c_str(), converged.c_str(),
+                      run_time.c_str(), ci95.c_str());
+            results_file.add_field("adaptive", converged);
+            results_file.add_field("run_time", run_time);
+            results_file.add_field("frame_time_ci95", ci95);
+        }
+
+        if (stats.warmup_frames > 0)
+        {
+            std::string warmup_frames = Util::toString(stats.warmup_frames);
+            std::string warmup_time =
+                Util::toString(1000.0 * stats.average_warmup_frame_time, 3);
+            std::string warmup_max_time =
+                Util::toString(1000.0 * stats.max_warmup_frame_time, 3);
+
+            Log::info(format_warmup.c_str(), stats.warmup_frames,
+                      warmup_time.c_str(), warmup_max_time.c_str());
+            results_file.add_field("warmup_frames", warmup_frames);
+            results_file.add_field("warmup_frame_time", warmup_time);
+            results_file.add_field("warmup_max_frame_time", warmup_max_time);
+        }
+
+        if (Baseline::enabled())
+        {
+            Baseline::Comparison comparison =
+                Baseline::compare(scene_->info_string(), stats.average_frame_time,
+                                  scene_->frame_times());
+            std::string base_time = "n/a";
+            std::string change = "n/a";
+            std::string frame_time = Util::toString(comparison.current_frame_time, 3);
+            std::string status = Baseline::status_name(comparison.status);
+
+            if (comparison.status != Baseline::StatusMissing) {
+                base_time = Util::toString(comparison.baseline_frame_time, 3);
+                change = Util::toString(100.0 * comparison.change, 2);
+            }
+
+            /* Make regressions stand out in the log */
+            std::string flag = comparison.status == Baseline::StatusRegression ?
+                "REGRESSION" : status;
+            std::string change_percent = change == "n/a" ?
+                change : (comparison.change >= 0.0 ? "+" : "") + change + "%";
+
+            Log::info(format_baseline.c_str(), base_time.c_str(), frame_time.c_str(),
+                      change_percent.c_str(), flag.c_str());
+            results_file.add_field("baseline_frame_time", base_time);
+            results_file.add_field("baseline_change", change);
+            results_file.add_field("baseline_status", status);
+        }
+
         if (Options::results == 0)
         {
             Log::info(format_done.c_str());
         }
 
         Log::info(format_newline.c_str());
+
+        if (Options::results & Options::ResultsFrameTime)
+        {
+            const LogHistogram &hist = stats.frame_time_histogram;
+            std::stringstream ss;
+
+            /* Only report the buckets that contain frames */
+            for (unsigned int i = 0; i < hist.size(); i++) {
+                if (hist.count(i) == 0)
+                    continue;
+
+                Log::info(format_histogram_bucket.c_str(),
+                          1000.0 * hist.lower_bound(i),
+                          1000.0 * hist.upper_bound(i),
+                          static_cast<unsigned long long>(hist.count(i)));
+
+                if (!ss.str().empty())
+                    ss << ";";
+                ss << Util::toString(1000.0 * hist.lower_bound(i), 3) << "-"
+                   << Util::toString(1000.0 * hist.upper_bound(i), 3) << ":"
+                   << hist.count(i);
+            }
+
+            results_file.add_field("frame_time_histogram", ss.str());
+        }
+
+        if (Options::results & Options::ResultsPhases)
+        {
+            Log::info(format_phase_header.c_str(),
+                      "Phase (ms)", "avg", "p50", "p90", "p99");
+
+            for (int i = 0; i < Scene::FramePhaseCount; i++) {
+                const Scene::PhaseStats &phase = stats.phase_time[i];
+                std::string name =
+                    Scene::frame_phase_name(static_cast<Scene::FramePhase>(i));
+
+                Log::info(format_phase.c_str(), name.c_str(),
+                          1000.0 * phase.average, 1000.0 * phase.median,
+                          1000.0 * phase.p90, 1000.0 * phase.p99);
+
+                results_file.add_field("phase_" + name + "_avg",
+                                       Util::toString(1000.0 * phase.average, 3));
+                results_file.add_field("phase_" + name + "_p50",
+                                       Util::toString(1000.0 * phase.median, 3));
+                results_file.add_field("phase_" + name + "_p90",
+                                       Util::toString(1000.0 * phase.p90, 3));
+                results_file.add_field("phase_" + name + "_p99",
+                                       Util::toString(1000.0 * phase.p99, 3));
+            }
+        }
+
+        if (Options::results_frames)
+        {
+            auto add_times = [&results_file](const std::string &name,
+                                             const std::vector<double> &times) {
+                std::vector<double> ms(times.size());
+                for (size_t i = 0; i < times.size(); i++)
+                    ms[i] = 1000.0 * times[i];
+                results_file.add_array(name, ms);
+            };
+
+            add_times("frame_times", scene_->frame_times());
+            if (stats.warmup_frames > 0)
+                add_times("warmup_frame_times", scene_->warmup_frame_times());
+            if (Options::results & Options::ResultsGpu)
+                add_times("gpu_frame_times", scene_->gpu_frame_times());
+            if (Options::results & Options::ResultsPhases) {
+                for (int i = 0; i < Scene::FramePhaseCount; i++) {
+                    Scene::FramePhase phase = static_cast<Scene::FramePhase>(i);
+                    add_times(std::string("phase_") + Scene::frame_phase_name(phase) + "_times",
+                              scene_->frame_phase_times(phase));
+                }
+            }
+        }
+
         results_file.add_field("status", "Success");
+
+        if (MetricsExporter::enabled())
+            MetricsExporter::end_benchmark(stats);
     }
     else if (scene_setup_status_ == SceneSetupStatusUnsupported) {
         Log::info(format_unsupported.c_str());
         results_file.add_field("status", "Unsupported");
+
+        if (MetricsExporter::enabled())
+            MetricsExporter::end_benchmark_failed();
     }
     else {
         Log::info(format_fail.c_str());
         results_file.add_field("status", "Failure");
+
+        if (MetricsExporter::enabled())
+            MetricsExporter::end_benchmark_failed();
     }
 
     results_file.end_benchmark();
 }
 
+void
+MainLoop::log_repeat_summary()
+{
+    static const std::string format_runs(Log::continuation_prefix + " Runs: %u");
+    static const std::string format_fps(Log::continuation_prefix +
+                                        " FPS: %s +-%s (StdDev: %s, CV: %s%%)");
+    static const std::string format_frame(Log::continuation_prefix +
+                                          " FrameTime: %s +-%s ms (StdDev: %s ms, CV: %s%%)");
+    static const std::string format_newline(Log::continuation_prefix + "\n");
+    ResultsFile &results_file = ResultsFile::get();
+
+    Log::info("=======================================================\n");
+    Log::info("    Summary of %u runs (mean +-95%% confidence interval)\n",
+              Options::repeat);
+    Log::info("=======================================================\n");
+
+    for (auto bench : benchmarks_) {
+        auto iter = repeat_results_.find(bench);
+        if (iter == repeat_results_.end())
+            continue;
+
+        const RepeatResults &results = iter->second;
+        const std::vector<double> &frame_times = results.frame_times;
+
+        double fps_mean = Statistics::mean(results.fps);
+        double fps_stddev = Statistics::stddev(results.fps, fps_mean);
+        double frame_mean = Statistics::mean(frame_times);
+        double frame_stddev = Statistics::stddev(frame_times, frame_mean);
+
+        std::string runs = Util::toString(results.fps.size());
+        std::string fps = Util::toString(fps_mean, 2);
+        std::string fps_ci95 =
+            Util::toString(Statistics::ci95_half_width(results.fps, fps_stddev), 2);
+        std::string fps_sd = Util::toString(fps_stddev, 2);
+        std::string fps_cv = Util::toString(100.0 * fps_stddev / fps_mean, 2);
+        std::string frame_time = Util::toString(1000.0 * frame_mean, 3);
+        std::string frame_ci95 =
+            Util::toString(1000.0 * Statistics::ci95_half_width(frame_times, frame_stddev), 3);
+        std::string frame_sd = Util::toString(1000.0 * frame_stddev, 3);
+        std::string frame_cv = Util::toString(100.0 * frame_stddev / frame_mean, 2);
+
+        Log::info("%s:", results.info_string.c_str());
+        Log::info(format_runs.c_str(), static_cast<unsigned>(results.fps.size()));
+        Log::info(format_fps.c_str(), fps.c_str(), fps_ci95.c_str(),
+                  fps_sd.c_str(), fps_cv.c_str());
+        Log::info(format_frame.c_str(), frame_time.c_str(), frame_ci95.c_str(),
+                  frame_sd.c_str(), frame_cv.c_str());
+        Log::info(format_newline.c_str());
+
+        results_file.begin_summary();
+        results_file.add_field("name", results.info_string);
+        results_file.add_field("runs", runs);
+        results_file.add_field("fps_mean", fps);
+        results_file.add_field("fps_stddev", fps_sd);
+        results_file.add_field("fps_cv", fps_cv);
+        results_file.add_field("fps_ci95", fps_ci95);
+        results_file.add_field("frame_time_mean", frame_time);
+        results_file.add_field("frame_time_stddev", frame_sd);
+        results_file.add_field("frame_time_cv", frame_cv);
+        results_file.add_field("frame_time_ci95", frame_ci95);
+        results_file.end_summary();
+    }
+}
+
+void
+MainLoop::log_scaling_summary()
+{
+    ResultsFile &results_file = ResultsFile::get();
+    std::vector<const Benchmark::Sweep *> sweeps;
+
+    for (auto bench : benchmarks_) {
+        const Benchmark::Sweep *sweep = bench->sweep().get();
+        if (sweep && repeat_results_.count(bench) &&
+            std::find(sweeps.begin(), sweeps.end(), sweep) == sweeps.end())
+        {
+            sweeps.push_back(sweep);
+        }
+    }
+
+    if (sweeps.empty())
+        return;
+
+    Log::info("=======================================================\n");
+    Log::info("    Scaling of swept options\n");
+    Log::info("=======================================================\n");
+
+    for (auto sweep : sweeps) {
+        for (auto const& swept : sweep->options) {
+            /*
+             * A curve for each combination of the other swept values, with
+             * the mean frame time in seconds of each swept value
+             */
+            std::vector<std::string> curve_names;
+            std::map<std::string, std::vector<std::pair<std::string, double> > > curves;
+
+            for (auto bench : benchmarks_) {
+                auto iter = repeat_results_.find(bench);
+                if (bench->sweep().get() != sweep || iter == repeat_results_.end())
+                    continue;
+
+                std::map<std::string, std::string> values;
+                for (auto const& opt : bench->options())
+                    values[opt.first] = opt.second;
+
+                std::string fixed;
+                for (auto const& other : sweep->options) {
+                    if (other != swept)
+                        fixed += (fixed.empty() ? "" : ":") + other + "=" + values[other];
+                }
+
+                if (!curves.count(fixed))
+                    curve_names.push_back(fixed);
+                curves[fixed].push_back(std::make_pair(values[swept],
+                                                       Statistics::mean(iter->second.frame_times)));
+            }
+
+            for (auto const& fixed : curve_names) {
+                const auto &points = curves[fixed];
+                std::vector<double> x;
+                std::vector<double> frame_times;
+                std::vector<double> log_x;
+                std::vector<double> log_fps;
+                std::string points_str;
+                bool numeric = true;
+
+                if (fixed.empty())
+                    Log::info("%s [%s]:\n", sweep->description.c_str(), swept.c_str());
+                else
+                    Log::info("%s [%s, %s]:\n", sweep->description.c_str(),
+                              swept.c_str(), fixed.c_str());
+
+                for (auto const& point : points) {
+                    std::string fps = Util::toString(1.0 / point.second, 2);
+                    Log::info("    %s=%s: FPS: %s FrameTime: %s ms\n",
+                              swept.c_str(), point.first.c_str(), fps.c_str(),
+                              Util::toString(1000.0 * point.second, 3).c_str());
+                    points_str += (points_str.empty() ? "" : ";") + point.first + ":" + fps;
+
+                    char *end;
+                    double value = strtod(point.first.c_str(), &end);
+                    numeric = numeric && !point.first.empty() && *end == '\0';
+                    x.push_back(value);
+                    frame_times.push_back(1000.0 * point.second);
+                    if (value > 0.0) {
+                        log_x.push_back(std::log(value));
+                        log_fps.push_back(-std::log(point.second));
+                    }
+                }
+
+                std::string slope("n/a");
+                std::string intercept("n/a");
+                std::string r2("n/a");
+                std::string exponent("n/a");
+                Statistics::LinearFit fit;
+
+                if (numeric && Statistics::linear_fit(x, frame_times, fit)) {
+                    slope = Util::toString(fit.slope, 6);
+                    intercept = Util::toString(fit.intercept, 3);
+                    r2 = Util::toString(fit.r2, 3);
+
+                    /* FPS ~ x^exponent, only meaningful if all values are positive */
+                    if (log_x.size() == x.size() &&
+                        Statistics::linear_fit(log_x, log_fps, fit))
+                    {
+                        exponent = Util::toString(fit.slope, 3);
+                    }
+
+                    Log::info("    Fit: FrameTime: %s ms * %s + %s ms (R^2: %s)"
+                              " FPS: ~%s^%s\n",
+                              slope.c_str(), swept.c_str(), intercept.c_str(), r2.c_str(),
+                              swept.c_str(), exponent.c_str());
+                }
+
+                results_file.begin_summary();
+                results_file.add_field("name", sweep->description);
+                results_file.add_field("scaling_option", swept);
+                results_file.add_field("scaling_fixed", fixed);
+                results_file.add_field("scaling_points", points_str);
+                results_file.add_field("scaling_slope", slope);
+                results_file.add_field("scaling_intercept", intercept);
+                results_file.add_field("scaling_r2", r2);
+                results_file.add_field("scaling_exponent", exponent);
+                results_file.end_summary();
+            }
+        }
+    }
+}
+
 void
 MainLoop::next_benchmark()
 {
     bench_iter_++;
-    if (bench_iter_ == benchmarks_.end() && Options::run_forever)
-        bench_iter_ = benchmarks_.begin();
+    if (bench_iter_ == run_order_.end() && Options::run_forever)
+        bench_iter_ = run_order_.begin();
+
+    /* Every pass over the benchmarks starts from the original defaults */
+    if (bench_iter_ != run_order_.end() &&
+        (bench_iter_ - run_order_.begin()) % pass_length_ == 0)
+    {
+        restore_option_defaults();
+    }
+}
+
+Benchmark *
+MainLoop::next_scene_benchmark()
+{
+    auto iter = bench_iter_ + 1;
+
+    if (iter == run_order_.end() && Options::run_forever)
+        iter = run_order_.begin();
+
+    /* Option-setting benchmarks don't touch the loaded resources */
+    while (iter != run_order_.end() && (*iter)->scene().name().empty())
+        iter++;
+
+    return iter != run_order_.end() ? *iter : nullptr;
+}
+
+bool
+MainLoop::next_benchmark_uses_scene(Scene &scene)
+{
+    Benchmark *next = next_scene_benchmark();
+
+    return next && &next->scene() == &scene;
+}
+
+void
+MainLoop::record_frame_phases(uint64_t clear_start, uint64_t draw_start,
+                              uint64_t update_start, uint64_t update_end,
+                              uint64_t canvas_start)
+{
+    const Canvas::UpdateTimes &update_times = canvas_.update_times();
+    double times[Scene::FramePhaseCount];
+
+    times[Scene::FramePhaseClear] = (draw_start - clear_start) / 1000000.0;
+    times[Scene::FramePhaseDraw] = (update_start - draw_start) / 1000000.0;
+    times[Scene::FramePhaseUpdate] = (update_end - update_start) / 1000000.0;
+    times[Scene::FramePhaseFrameEnd] = update_times.frame_end;
+    times[Scene::FramePhaseFlip] = update_times.flip;
+    times[Scene::FramePhaseSyncWait] = update_times.sync_wait;
+
+    scene_->add_frame_phase_times(times);
+
+    /*
+     * Report the frame time the scene statistics are based on. The frame
+     * times are cleared when the warm-up ends, so the frame that ends it
+     * is not reported either.
+     */
+    const std::vector<double> &frame_times = scene_->frame_times();
+    bool measured = !scene_->warming_up() && !frame_times.empty();
+
+    if (measured) {
+        ResultsFile::get().add_frame(frame_times.back());
+        if (MetricsExporter::enabled())
+            MetricsExporter::add_frame(frame_times.back());
+    }
+
+    uint64_t frame_end = Util::get_timestamp_us();
+    if (FrameLog::enabled())
+        FrameLog::add_frame(frame_end);
+
+    if (Trace::enabled()) {
+        uint64_t frame_end_us = update_times.frame_end * 1000000.0;
+        uint64_t flip_us = update_times.flip * 1000000.0;
+        uint64_t sync_wait_us = update_times.sync_wait * 1000000.0;
+
+        Trace::add_span("frame", "frame", clear_start, frame_end);
+        Trace::add_span("clear", "phase", clear_start, draw_start);
+        Trace::add_span("draw", "phase", draw_start, update_start);
+        Trace::add_span("update", "phase", update_start, update_end);
+        Trace::add_span("canvas_update", "phase", canvas_start, frame_end);
+
+        /*
+         * The canvas only reports the durations of its parts, so place
+         * them relative to the start and end of the canvas update.
+         */
+        Trace::add_span("frame_end", "phase", canvas_start,
+                        canvas_start + frame_end_us);
+        if (flip_us > 0) {
+            Trace::add_span("flip", "phase", canvas_start + frame_end_us,
+                            canvas_start + frame_end_us + flip_us);
+        }
+        if (sync_wait_us > 0)
+            Trace::add_span("sync_wait", "phase", frame_end - sync_wait_us, frame_end);
+    }
+}
+
+void
+MainLoop::build_run_order()
+{
+    run_order_.clear();
+
+    if (Options::repeat_order == Options::RepeatOrderSequential) {
+        for (auto bench : benchmarks_) {
+            /* Option-setting benchmarks only need to run once */
+            unsigned int count = bench->scene().name().empty() ? 1 : Options::repeat;
+            run_order_.insert(run_order_.end(), count, bench);
+        }
+        pass_length_ = run_order_.size();
+        return;
+    }
+
+    std::mt19937 rng;
+    if (Options::repeat_order == Options::RepeatOrderShuffled) {
+        unsigned int seed = std::random_device()();
+        Log::debug("Shuffling repeated runs with seed %u\n", seed);
+        rng.seed(seed);
+    }
+
+    for (unsigned int i = 0; i < Options::repeat; i++) {
+        auto pass = run_order_.insert(run_order_.end(),
+                                      benchmarks_.begin(), benchmarks_.end());
+
+        if (Options::repeat_order != Options::RepeatOrderShuffled)
+            continue;
+
+        /*
+         * Only shuffle the benchmarks between option-setting entries, so
+         * that each benchmark still runs with the same default options.
+         */
+        while (pass != run_order_.end()) {
+            auto group_end = std::find_if(pass, run_order_.end(),
+                [](Benchmark *b) { return b->scene().name().empty(); });
+            std::shuffle(pass, group_end, rng);
+            pass = group_end == run_order_.end() ? group_end : group_end + 1;
+        }
+    }
+
+    pass_length_ = benchmarks_.size();
+}
+
+void
+MainLoop::save_option_defaults()
+{
+    for (auto &scene : Benchmark::scenes()) {
+        for (auto &opt : scene.second->options())
+            option_defaults_[scene.second][opt.first] = opt.second.default_value;
+    }
+}
+
+void
+MainLoop::restore_option_defaults()
+{
+    for (auto &scene : option_defaults_) {
+        for (auto &opt : scene.second)
+            scene.first->set_option_default(opt.first, opt.second);
+    }
 }
 
 /**********************
@@ -270,10 +956,15 @@ MainLoopDecoration::draw()
 {
     static const unsigned int fps_interval = 500000;
 
+    uint64_t clear_start = Util::get_timestamp_us();
     canvas_.clear();
 
+    uint64_t draw_start = Util::get_timestamp_us();
     scene_->draw();
+
+    uint64_t update_start = Util::get_timestamp_us();
     scene_->update();
+    uint64_t update_end = Util::get_timestamp_us();
 
     if (show_fps_) {
         uint64_t now = Util::get_timestamp_us();
@@ -288,7 +979,13 @@ MainLoopDecoration::draw()
     if (show_title_)
         title_renderer_->render();
 
+    uint64_t canvas_start = Util::get_timestamp_us();
     canvas_.update();
+
+    record_frame_phases(clear_start, draw_start, update_start, update_end,
+                        canvas_start);
+
+    scene_->collect_gpu_times();
 }
 
 void
@@ -26,6 +26,8 @@
 #include "benchmark.h"
 #include "text-renderer.h"
 #include "vec.h"
+#include <map>
+#include <string>
 #include <vector>
 
 /**
@@ -83,6 +85,16 @@ public:
      */
     virtual void log_scene_result();
 
+    /**
+     * Overridable method for logging the statistics of repeated runs.
+     */
+    virtual void log_repeat_summary();
+
+    /**
+     * Overridable method for logging the scaling curves of parameter sweeps.
+     */
+    virtual void log_scaling_summary();
+
 protected:
     enum SceneSetupStatus {
         SceneSetupStatusUnknown,
@@ -90,15 +102,36 @@ protected:
         SceneSetupStatusFailure,
         SceneSetupStatusUnsupported
     };
+    struct RepeatResults {
+        std::string info_string;
+        /* The average frame time in seconds and the FPS of each run */
+        std::vector<double> frame_times;
+        std::vector<double> fps;
+    };
     void next_benchmark();
+    Benchmark *next_scene_benchmark();
+    bool next_benchmark_uses_scene(Scene &scene);
+    void record_frame_phases(uint64_t clear_start, uint64_t draw_start,
+                             uint64_t update_start, uint64_t update_end,
+                             uint64_t canvas_start);
+    void build_run_order();
+    void save_option_defaults();
+    void restore_option_defaults();
     Canvas &canvas_;
     Scene *scene_;
     const std::vector<Benchmark *> &benchmarks_;
     unsigned int score_;
     unsigned int benchmarks_run_;
     SceneSetupStatus scene_setup_status_;
+    uint64_t benchmark_start_;
 
+    /* The benchmarks in the order they are run, including repeats */
+    std::vector<Benchmark *> run_order_;
+    /* The number of entries in run_order_ that make up a single pass */
+    size_t pass_length_;
     std::vector<Benchmark *>::const_iterator bench_iter_;
+    std::map<Benchmark *, RepeatResults> repeat_results_;
+    std::map<Scene *, std::map<std::string, std::string> > option_defaults_;
 };
 
 /**
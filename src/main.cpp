@@ -32,6 +32,14 @@
 #include "benchmark-collection.h"
 #include "scene-collection.h"
 #include "results-file.h"
+#include "trace.h"
+#include "baseline.h"
+#include "frame-log.h"
+#include "metrics-exporter.h"
+#include "program-cache.h"
+#include "mesh-cache.h"
+#include "asset-prefetcher.h"
+#include "results-compare.h"
 
 #include "canvas-generic.h"
 
@@ -129,6 +137,9 @@ do_benchmark(Canvas &canvas)
     Log::info("                                  glmark2 Score: %u \n", loop->score());
     Log::info("=======================================================\n");
 
+    Baseline::log_summary();
+    ProgramCache::log_summary();
+
     delete loop;
 }
 
@@ -182,11 +193,10 @@ main(int argc, char *argv[])
     /* Initialize Log class */
     Log::init(std::filesystem::path(argv[0]).stem().string(), Options::show_debug);
 
-    if (!ResultsFile::init(Options::results_file)) {
-        Log::error("%s: Could not initialize results file\n", __FUNCTION__);
-        return 1;
-    }
-
+    /*
+     * Handle the commands that don't run any benchmarks before anything
+     * creates output files, cache directories or connects result streams.
+     */
     if (Options::show_help) {
         Options::print_help();
         return 0;
@@ -197,6 +207,65 @@ main(int argc, char *argv[])
         return 0;
     }
 
+    /* Comparing results files doesn't need a canvas */
+    if (Options::compare) {
+        ResultsCompare::Format format = Options::compare_format == Options::CompareFormatJSON ?
+            ResultsCompare::FormatJSON : ResultsCompare::FormatText;
+        return ResultsCompare::run(Options::compare_files, format) ? 0 : 1;
+    }
+
+    if (!Options::frame_log_dump.empty()) {
+        FrameLog::Format format = Options::frame_log_format == Options::FrameLogFormatJSON ?
+            FrameLog::FormatJSON : FrameLog::FormatCSV;
+        return FrameLog::dump(Options::frame_log_dump, format) ? 0 : 1;
+    }
+
+    if (!ResultsFile::init(Options::results_file)) {
+        Log::error("%s: Could not initialize results file\n", __FUNCTION__);
+        return 1;
+    }
+
+    if (!ResultsFile::init_stream(Options::results_stream, Options::results_stream_frames)) {
+        Log::error("%s: Could not initialize results stream\n", __FUNCTION__);
+        return 1;
+    }
+
+    if (!Trace::init(Options::trace_file)) {
+        Log::error("%s: Could not initialize trace file\n", __FUNCTION__);
+        return 1;
+    }
+
+    if (!FrameLog::init(Options::frame_log)) {
+        Log::error("%s: Could not initialize frame log\n", __FUNCTION__);
+        return 1;
+    }
+
+    if (!MetricsExporter::init(Options::metrics_file, Options::metrics_interval)) {
+        Log::error("%s: Could not initialize metrics file\n", __FUNCTION__);
+        return 1;
+    }
+
+    if (!Baseline::init(Options::baseline, Options::max_regression)) {
+        Log::error("%s: Could not load baseline results\n", __FUNCTION__);
+        return 1;
+    }
+
+    ProgramCache::Mode program_cache_mode = ProgramCache::ModeUse;
+    if (Options::program_cache_mode == Options::ProgramCacheModeBypass)
+        program_cache_mode = ProgramCache::ModeBypass;
+    else if (Options::program_cache_mode == Options::ProgramCacheModeRefresh)
+        program_cache_mode = ProgramCache::ModeRefresh;
+
+    if (!ProgramCache::init(Options::program_cache, program_cache_mode)) {
+        Log::error("%s: Could not initialize program cache\n", __FUNCTION__);
+        return 1;
+    }
+
+    if (!MeshCache::init(Options::mesh_cache)) {
+        Log::error("%s: Could not initialize mesh cache\n", __FUNCTION__);
+        return 1;
+    }
+
     /* Force 800x600 output for validation */
     if (Options::validate &&
         Options::size != std::pair<int,int>(800, 600))
@@ -261,6 +330,9 @@ main(int argc, char *argv[])
 
     results_file.end_info();
 
+    if (Options::prefetch_assets)
+        AssetPrefetcher::init();
+
     canvas.visible(true);
 
     if (Options::validate)
@@ -268,7 +340,15 @@ main(int argc, char *argv[])
     else
         do_benchmark(canvas);
 
+    AssetPrefetcher::finish();
     results_file.end();
+    Trace::finish();
+    MetricsExporter::finish();
+    FrameLog::finish();
+
+    /* Let scripts detect regressions against the baseline */
+    if (Baseline::regressed())
+        return 2;
 
     return 0;
 }
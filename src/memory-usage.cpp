@@ -0,0 +1,148 @@
+/*
+ * Copyright © 2026 Collabora Limited
+ *
+ * This file is part of the glmark2 OpenGL (ES) 2.0 benchmark.
+ *
+ * glmark2 is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * glmark2 is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * glmark2.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "memory-usage.h"
+#include "gl-headers.h"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+namespace
+{
+
+/**
+ * Reads a "Name:   value kB" field from a /proc file.
+ *
+ * @return the value in KiB, or -1 if the field isn't available
+ */
+int64_t
+read_proc_field(const char *path, const std::string &name)
+{
+    std::ifstream ifs(path);
+    std::string line;
+
+    while (std::getline(ifs, line)) {
+        if (line.compare(0, name.size(), name) != 0 ||
+            line.size() <= name.size() || line[name.size()] != ':')
+        {
+            continue;
+        }
+
+        std::stringstream ss(line.substr(name.size() + 1));
+        int64_t value = -1;
+        ss >> value;
+        return value;
+    }
+
+    return -1;
+}
+
+int64_t
+gl_available_memory()
+{
+    if (GLExtensions::support("GL_NVX_gpu_memory_info")) {
+        GLint available = 0;
+        glGetIntegerv(GL_GPU_MEMORY_INFO_CURRENT_AVAILABLE_VIDMEM_NVX, &available);
+        return available;
+    }
+
+    if (GLExtensions::support("GL_ATI_meminfo")) {
+        /* The first value is the total free memory in the texture pool */
+        GLint info[4] = {0, 0, 0, 0};
+        glGetIntegerv(GL_TEXTURE_FREE_MEMORY_ATI, info);
+        return info[0];
+    }
+
+    return -1;
+}
+
+int64_t
+min_available(int64_t a, int64_t b)
+{
+    if (a < 0 || b < 0)
+        return std::max(a, b);
+    return std::min(a, b);
+}
+
+}
+
+MemorySample
+MemorySample::current()
+{
+    MemorySample sample;
+
+    sample.rss = read_proc_field("/proc/self/status", "VmRSS");
+    sample.pss = read_proc_field("/proc/self/smaps_rollup", "Pss");
+    sample.gl_available = gl_available_memory();
+
+    return sample;
+}
+
+/*****************
+ * MemoryMonitor *
+ *****************/
+
+void
+MemoryMonitor::start()
+{
+    /*
+     * Reset the peak RSS of the process (VmHWM), so that it reflects
+     * only this run, including any spikes between samples.
+     */
+    std::ofstream clear_refs("/proc/self/clear_refs");
+    clear_refs << "5" << std::flush;
+    peak_rss_reset_ = clear_refs.good();
+
+    baseline_ = MemorySample::current();
+    peak_ = baseline_;
+    final_ = MemorySample();
+    active_ = true;
+}
+
+void
+MemoryMonitor::update()
+{
+    if (!active_)
+        return;
+
+    add_to_peak(MemorySample::current());
+}
+
+void
+MemoryMonitor::stop()
+{
+    if (!active_)
+        return;
+
+    final_ = MemorySample::current();
+    add_to_peak(final_);
+    active_ = false;
+}
+
+void
+MemoryMonitor::add_to_peak(const MemorySample &sample)
+{
+    peak_.rss = std::max<int64_t>(peak_.rss, sample.rss);
+    peak_.pss = std::max<int64_t>(peak_.pss, sample.pss);
+    peak_.gl_available = min_available(peak_.gl_available, sample.gl_available);
+
+    if (peak_rss_reset_)
+        peak_.rss = std::max<int64_t>(peak_.rss, read_proc_field("/proc/self/status", "VmHWM"));
+}
@@ -0,0 +1,101 @@
+/*
+ * Copyright © 2026 Collabora Limited
+ *
+ * This file is part of the glmark2 OpenGL (ES) 2.0 benchmark.
+ *
+ * glmark2 is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * glmark2 is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * glmark2.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef GLMARK2_MEMORY_USAGE_H_
+#define GLMARK2_MEMORY_USAGE_H_
+
+#include <stdint.h>
+
+/**
+ * The memory used by the process and the GL implementation at some point.
+ *
+ * All values are in KiB, or -1 if not available.
+ */
+struct MemorySample {
+    MemorySample() : rss(-1), pss(-1), gl_available(-1) {}
+
+    /**
+     * Samples the current memory usage.
+     *
+     * Sampling reads files in /proc and queries the GL, so it shouldn't be
+     * done while rendering frames. The GL context must be current.
+     */
+    static MemorySample current();
+
+    /** The resident set size of the process */
+    int64_t rss;
+    /** The proportional set size of the process */
+    int64_t pss;
+    /**
+     * The free video memory reported by GL_NVX_gpu_memory_info or
+     * GL_ATI_meminfo
+     */
+    int64_t gl_available;
+};
+
+/**
+ * Tracks the memory usage over a scene run.
+ *
+ * The baseline is sampled before the scene allocates its resources and
+ * the final sample after it has released them, so any difference between
+ * the two is memory that the scene failed to release.
+ */
+class MemoryMonitor
+{
+public:
+    MemoryMonitor() : active_(false), peak_rss_reset_(false) {}
+
+    /**
+     * Samples the baseline memory usage and starts tracking the peak.
+     */
+    void start();
+
+    /**
+     * Samples the memory usage, updating the peak.
+     */
+    void update();
+
+    /**
+     * Samples the final memory usage and stops tracking.
+     */
+    void stop();
+
+    /**
+     * Whether tracking is in progress.
+     */
+    bool active() const { return active_; }
+
+    const MemorySample &baseline() const { return baseline_; }
+    /**
+     * Gets the peak memory usage. For GL memory this is the lowest
+     * available memory.
+     */
+    const MemorySample &peak() const { return peak_; }
+    const MemorySample &final() const { return final_; }
+
+private:
+    void add_to_peak(const MemorySample &sample);
+
+    bool active_;
+    bool peak_rss_reset_;
+    MemorySample baseline_;
+    MemorySample peak_;
+    MemorySample final_;
+};
+
+#endif /* GLMARK2_MEMORY_USAGE_H_ */
@@ -0,0 +1,297 @@
+/*
+ * Copyright © 2026 Collabora Limited
+ *
+ * This file is part of the glmark2 OpenGL (ES) 2.0 benchmark.
+ *
+ * glmark2 is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * glmark2 is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * glmark2.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "mesh-cache.h"
+#include "log.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <thread>
+
+#if !defined(_WIN32)
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+
+const char cache_magic[8] = {'G', 'L', 'M', '2', 'M', 'E', 'S', 'H'};
+const uint32_t cache_version = 1;
+/* Files written with a different byte order don't match this value */
+const uint32_t cache_byte_order = 0x01020304;
+/* The alignment of the stream data in the file */
+const uint64_t stream_alignment = 8;
+
+/* The header of a cache file, followed by the stream table */
+struct CacheHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint64_t source_size;
+    int64_t source_mtime;
+    uint32_t nstreams;
+    uint32_t reserved;
+};
+
+/* An entry of the stream table, with the offset from the start of the file */
+struct StreamInfo {
+    uint64_t offset;
+    uint64_t size;
+};
+
+std::filesystem::path cache_dir;
+
+/* 64-bit FNV-1a */
+uint64_t
+hash_string(const std::string &str)
+{
+    uint64_t hash = 0xcbf29ce484222325ULL;
+
+    for (auto c : str) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 0x100000001b3ULL;
+    }
+
+    return hash;
+}
+
+/*
+ * The cache file of a source, named after the source file and a hash of
+ * its full path, so sources with the same name in different directories
+ * don't share a cache file.
+ */
+std::filesystem::path
+cache_path(const std::filesystem::path &source)
+{
+    char hash[32];
+    snprintf(hash, sizeof(hash), "-%016llx.glmesh",
+             static_cast<unsigned long long>(hash_string(source.string())));
+    return cache_dir / (source.filename().string() + hash);
+}
+
+/* Gets the size and modification time of a source file */
+bool
+source_info(const std::filesystem::path &source, uint64_t &size, int64_t &mtime)
+{
+    std::error_code ec;
+
+    size = std::filesystem::file_size(source, ec);
+    if (ec)
+        return false;
+
+    auto time = std::filesystem::last_write_time(source, ec);
+    if (ec)
+        return false;
+
+    mtime = time.time_since_epoch().count();
+
+    return true;
+}
+
+}
+
+bool MeshCache::enabled_ = false;
+
+MeshCache::Entry::~Entry()
+{
+#if !defined(_WIN32)
+    if (map_)
+        munmap(map_, map_size_);
+#endif
+}
+
+bool
+MeshCache::init(const std::string &dir)
+{
+    if (dir.empty())
+        return true;
+
+    std::error_code ec;
+    std::filesystem::create_directories(dir, ec);
+    if (ec) {
+        Log::error("Failed to create mesh cache directory %s: %s\n",
+                   dir.c_str(), ec.message().c_str());
+        return false;
+    }
+
+    cache_dir = dir;
+    enabled_ = true;
+
+    return true;
+}
+
+std::unique_ptr<MeshCache::Entry>
+MeshCache::load(const std::filesystem::path &source)
+{
+    uint64_t source_size;
+    int64_t source_mtime;
+
+    if (!source_info(source, source_size, source_mtime))
+        return nullptr;
+
+    std::filesystem::path path = cache_path(source);
+    std::unique_ptr<Entry> entry(new Entry());
+    const char *data = nullptr;
+    size_t size = 0;
+
+#if !defined(_WIN32)
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return nullptr;
+
+    off_t file_size = lseek(fd, 0, SEEK_END);
+    if (file_size > 0) {
+        void *map = mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (map != MAP_FAILED) {
+            entry->map_ = map;
+            entry->map_size_ = file_size;
+            data = static_cast<const char *>(map);
+            size = file_size;
+        }
+    }
+    close(fd);
+#else
+    std::ifstream ifs(path, std::ios::binary | std::ios::ate);
+    if (ifs) {
+        entry->buffer_.resize(ifs.tellg());
+        ifs.seekg(0);
+        if (ifs.read(entry->buffer_.data(), entry->buffer_.size())) {
+            data = entry->buffer_.data();
+            size = entry->buffer_.size();
+        }
+    }
+#endif
+
+    if (!data || size < sizeof(CacheHeader))
+        return nullptr;
+
+    CacheHeader header;
+    memcpy(&header, data, sizeof(header));
+
+    if (memcmp(header.magic, cache_magic, sizeof(cache_magic)) != 0 ||
+        header.version != cache_version || header.byte_order != cache_byte_order ||
+        header.source_size != source_size || header.source_mtime != source_mtime ||
+        header.nstreams > (size - sizeof(header)) / sizeof(StreamInfo))
+    {
+        Log::debug("Mesh cache: ignoring stale %s\n", path.string().c_str());
+        return nullptr;
+    }
+
+    const char *table = data + sizeof(header);
+
+    for (uint32_t i = 0; i < header.nstreams; i++) {
+        StreamInfo info;
+        memcpy(&info, table + i * sizeof(info), sizeof(info));
+
+        if (info.offset > size || info.size > size - info.offset) {
+            Log::debug("Mesh cache: ignoring truncated %s\n", path.string().c_str());
+            return nullptr;
+        }
+
+        entry->streams_.push_back(std::make_pair(data + info.offset, info.size));
+    }
+
+    Log::debug("Mesh cache: loaded %s\n", path.string().c_str());
+
+    return entry;
+}
+
+void
+MeshCache::store(const std::filesystem::path &source, const std::vector<Stream> &streams)
+{
+    CacheHeader header;
+
+    memcpy(header.magic, cache_magic, sizeof(cache_magic));
+    header.version = cache_version;
+    header.byte_order = cache_byte_order;
+    header.nstreams = streams.size();
+    header.reserved = 0;
+
+    if (!source_info(source, header.source_size, header.source_mtime))
+        return;
+
+    std::vector<StreamInfo> table(streams.size());
+    uint64_t offset = sizeof(header) + table.size() * sizeof(StreamInfo);
+
+    for (size_t i = 0; i < streams.size(); i++) {
+        offset = (offset + stream_alignment - 1) & ~(stream_alignment - 1);
+        table[i].offset = offset;
+        table[i].size = streams[i].second;
+        offset += streams[i].second;
+    }
+
+    /*
+     * Write to a temporary file and rename it, so readers never see a partial
+     * file. The prefetch thread and the main thread may store the same source
+     * at the same time, so each writer gets its own temporary file.
+     */
+    std::filesystem::path path = cache_path(source);
+    std::filesystem::path tmp_path = path;
+#if !defined(_WIN32)
+    std::string tmp_template = path.string() + ".XXXXXX";
+    int fd = mkstemp(&tmp_template[0]);
+    if (fd < 0) {
+        Log::debug("Mesh cache: failed to create a temporary file for %s\n",
+                   path.string().c_str());
+        return;
+    }
+    close(fd);
+    tmp_path = tmp_template;
+#else
+    tmp_path += ".tmp" + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id()));
+#endif
+    std::error_code ec;
+
+    {
+        std::ofstream ofs(tmp_path, std::ios::binary | std::ios::trunc);
+        static const char padding[stream_alignment] = {0};
+
+        ofs.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        ofs.write(reinterpret_cast<const char *>(table.data()),
+                  table.size() * sizeof(StreamInfo));
+
+        uint64_t pos = sizeof(header) + table.size() * sizeof(StreamInfo);
+
+        for (size_t i = 0; i < streams.size(); i++) {
+            ofs.write(padding, table[i].offset - pos);
+            ofs.write(static_cast<const char *>(streams[i].first), streams[i].second);
+            pos = table[i].offset + table[i].size;
+        }
+
+        if (!ofs) {
+            Log::debug("Mesh cache: failed to write %s\n", tmp_path.string().c_str());
+            std::filesystem::remove(tmp_path, ec);
+            return;
+        }
+    }
+
+    std::filesystem::rename(tmp_path, path, ec);
+    if (ec) {
+        Log::debug("Mesh cache: failed to rename %s: %s\n",
+                   tmp_path.string().c_str(), ec.message().c_str());
+        std::filesystem::remove(tmp_path, ec);
+        return;
+    }
+
+    Log::debug("Mesh cache: stored %s\n", path.string().c_str());
+}
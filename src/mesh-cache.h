@@ -0,0 +1,125 @@
+/*
+ * Copyright © 2026 Collabora Limited
+ *
+ * This file is part of the glmark2 OpenGL (ES) 2.0 benchmark.
+ *
+ * glmark2 is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * glmark2 is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * glmark2.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef GLMARK2_MESH_CACHE_H_
+#define GLMARK2_MESH_CACHE_H_
+
+#include <cstddef>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * A persistent on-disk cache of parsed model files.
+ *
+ * Each source file is cached as a binary file holding a list of data
+ * streams, whose meaning is up to the code parsing the source. The cached
+ * file records the size and modification time of the source, and is
+ * ignored once the source changes. Cached files are mapped into memory
+ * where possible, so loading them doesn't need any parsing or copies
+ * beyond building the final objects.
+ */
+class MeshCache
+{
+public:
+    /**
+     * The streams of a cached file, valid while the entry exists.
+     */
+    class Entry
+    {
+    public:
+        ~Entry();
+
+        /**
+         * Gets a stream as an array of values.
+         *
+         * @param i the index of the stream
+         * @param count set to the number of values in the stream
+         *
+         * @return the values, or nullptr if there is no such stream, or its
+         *         size is not a multiple of the value size
+         */
+        template<typename T> const T *
+        stream(size_t i, size_t &count) const
+        {
+            if (i >= streams_.size() || streams_[i].second % sizeof(T) != 0)
+                return nullptr;
+
+            count = streams_[i].second / sizeof(T);
+            return reinterpret_cast<const T *>(streams_[i].first);
+        }
+
+        /**
+         * The number of streams.
+         */
+        size_t size() const { return streams_.size(); }
+
+    private:
+        friend class MeshCache;
+        Entry() : map_(nullptr), map_size_(0) {}
+
+        void *map_;
+        size_t map_size_;
+        std::vector<char> buffer_;
+        std::vector<std::pair<const char *, size_t>> streams_;
+    };
+
+    /** The data of a stream to store, and its size in bytes */
+    typedef std::pair<const void *, size_t> Stream;
+
+    /**
+     * Starts caching parsed models.
+     *
+     * @param dir the cache directory, which is created if needed, or an
+     *            empty string to disable caching
+     *
+     * @return whether the operation succeeded
+     */
+    static bool init(const std::string &dir);
+
+    /**
+     * Whether caching is enabled.
+     */
+    static bool enabled() { return enabled_; }
+
+    /**
+     * Loads the cached streams of a source file.
+     *
+     * @param source the source file
+     *
+     * @return the cached entry, or nullptr if the source is not cached, or
+     *         has changed since it was cached
+     */
+    static std::unique_ptr<Entry> load(const std::filesystem::path &source);
+
+    /**
+     * Caches the streams of a parsed source file.
+     *
+     * @param source the source file
+     * @param streams the streams to store
+     */
+    static void store(const std::filesystem::path &source,
+                      const std::vector<Stream> &streams);
+
+private:
+    static bool enabled_;
+};
+
+#endif /* GLMARK2_MESH_CACHE_H_ */
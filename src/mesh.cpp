@@ -26,10 +26,87 @@
 #include "gl-headers.h"
 
 #include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+
+/*
+ * Converts a float to a half float, rounding to the nearest value.
+ */
+uint16_t
+float_to_half(float f)
+{
+    uint32_t x;
+    memcpy(&x, &f, sizeof(x));
+
+    uint32_t sign = (x >> 16) & 0x8000;
+    int exp = static_cast<int>((x >> 23) & 0xff) - 127 + 15;
+    uint32_t mantissa = x & 0x7fffff;
+
+    /* Infinity and NaN */
+    if (((x >> 23) & 0xff) == 0xff)
+        return sign | 0x7c00 | (mantissa ? 0x200 : 0);
+
+    if (exp >= 31)
+        return sign | 0x7c00;
+
+    /* Values too small for a normal half float become denormals, or zero */
+    if (exp <= 0) {
+        if (exp < -10)
+            return sign;
+        mantissa |= 0x800000;
+        int shift = 14 - exp;
+        uint32_t half = mantissa >> shift;
+        if ((mantissa >> (shift - 1)) & 1)
+            half++;
+        return sign | half;
+    }
+
+    /* A carry from rounding the mantissa correctly increments the exponent */
+    uint32_t half = sign | (exp << 10) | (mantissa >> 13);
+    if (mantissa & 0x1000)
+        half++;
+
+    return half;
+}
+
+/* The simulated post-transform cache size for ::optimize_vertex_cache() */
+const int vertex_cache_size = 32;
+
+/*
+ * The score of a vertex in the linear-speed vertex cache optimisation
+ * (Tom Forsyth). Vertices that are in the cache, and vertices with few
+ * remaining triangles, score higher.
+ */
+float
+vertex_cache_score(int cache_pos, unsigned int remaining_triangles)
+{
+    if (remaining_triangles == 0)
+        return -1.0f;
+
+    float score = 0.0f;
+
+    if (cache_pos >= 0) {
+        /* The vertices of the last triangle get a fixed score, so it isn't reused right away */
+        if (cache_pos < 3)
+            score = 0.75f;
+        else
+            score = powf(1.0f - (cache_pos - 3) / static_cast<float>(vertex_cache_size - 3), 1.5f);
+    }
+
+    return score + 2.0f / sqrtf(static_cast<float>(remaining_triangles));
+}
+
+}
 
 Mesh::Mesh() :
-    vertex_size_(0), interleave_(false), vbo_update_method_(VBOUpdateMethodMap),
-    vbo_usage_(VBOUsageStatic)
+    vertex_size_(0), nvertices_(0), data_interleaved_(true), packed_stride_(0),
+    attribs_packed_(false),
+    index_type_(GL_UNSIGNED_SHORT), ibo_(0), arrays_built_(false),
+    interleave_(false), vbo_update_method_(VBOUpdateMethodMap),
+    vbo_usage_(VBOUsageStatic), use_vao_(false)
 {
 }
 
@@ -45,12 +122,19 @@ Mesh::~Mesh()
  * specifying the size in floats of each vertex attribute.
  *
  * e.g. {4, 3, 2} => 3 attributes vec4, vec3, vec2
+ *
+ * The storage formats set how each attribute is stored in the vertex arrays
+ * or VBOs, with missing ones defaulting to AttribFormatFloat. Formats that
+ * the GL doesn't support, or that can't represent the attribute values,
+ * fall back to wider ones when building them.
  */
 void
-Mesh::set_vertex_format(const std::vector<int> &format)
+Mesh::set_vertex_format(const std::vector<int> &format,
+                        const std::vector<AttribFormat> &storage)
 {
     int pos = 0;
     vertex_format_.clear();
+    component_attrib_.clear();
 
     for (std::vector<int>::const_iterator iter = format.begin();
          iter != format.end();
@@ -58,11 +142,15 @@ Mesh::set_vertex_format(const std::vector<int> &format)
     {
         int n = *iter;
         vertex_format_.push_back(std::pair<int,int>(n, pos));
+        component_attrib_.insert(component_attrib_.end(), n, iter - format.begin());
 
         pos += n;
     }
 
     vertex_size_ = pos;
+
+    attrib_formats_ = storage;
+    attrib_formats_.resize(vertex_format_.size(), AttribFormatFloat);
 }
 
 /*
@@ -79,6 +167,20 @@ Mesh::set_attrib_locations(const std::vector<int> &locations)
     attrib_locations_ = locations;
 }
 
+/**
+ * Preallocates storage for vertices.
+ *
+ * Adding up to this number of vertices with ::next_vertex() doesn't
+ * reallocate the vertex data.
+ *
+ * @param nvertices the total number of vertices the mesh is going to have
+ */
+void
+Mesh::reserve_vertices(size_t nvertices)
+{
+    data_.reserve(nvertices * vertex_size_);
+}
+
 
 /**
  * Checks that an attribute is of the correct dimensionality.
@@ -91,7 +193,7 @@ Mesh::set_attrib_locations(const std::vector<int> &locations)
 bool
 Mesh::check_attrib(unsigned int pos, int dim)
 {
-    if (pos > vertex_format_.size()) {
+    if (pos >= vertex_format_.size()) {
         Log::error("Trying to set non-existent attribute\n");
         return false;
     }
@@ -106,17 +208,20 @@ Mesh::check_attrib(unsigned int pos, int dim)
 
 
 /**
- * Ensures that we have a vertex to process.
+ * Gets the data of an attribute of the current vertex, adding a vertex if
+ * there isn't one yet.
  *
- * @return the vertex to process
+ * @param pos the position/index of the attribute
+ *
+ * @return the attribute data
  */
-std::vector<float> &
-Mesh::ensure_vertex()
+float *
+Mesh::current_attrib(unsigned int pos)
 {
-    if (vertices_.empty())
+    if (nvertices_ == 0)
         next_vertex();
 
-    return vertices_.back();
+    return attrib_data(nvertices_ - 1, pos);
 }
 
 /*
@@ -128,57 +233,55 @@ Mesh::ensure_vertex()
  * etc
  */
 void
-Mesh::set_attrib(unsigned int pos, const LibMatrix::vec2 &v, std::vector<float> *vertex)
+Mesh::set_attrib(unsigned int pos, const LibMatrix::vec2 &v)
 {
     if (!check_attrib(pos, 2))
         return;
 
-    std::vector<float> &vtx = !vertex ? ensure_vertex() : *vertex;
-
-    int offset = vertex_format_[pos].second;
+    float *dest = current_attrib(pos);
 
-    vtx[offset] = v.x();
-    vtx[offset + 1] = v.y();
+    dest[0] = v.x();
+    dest[1] = v.y();
 }
 
 void
-Mesh::set_attrib(unsigned int pos, const LibMatrix::vec3 &v, std::vector<float> *vertex)
+Mesh::set_attrib(unsigned int pos, const LibMatrix::vec3 &v)
 {
     if (!check_attrib(pos, 3))
         return;
 
-    std::vector<float> &vtx = !vertex ? ensure_vertex() : *vertex;
-
-    int offset = vertex_format_[pos].second;
+    float *dest = current_attrib(pos);
 
-    vtx[offset] = v.x();
-    vtx[offset + 1] = v.y();
-    vtx[offset + 2] = v.z();
+    dest[0] = v.x();
+    dest[1] = v.y();
+    dest[2] = v.z();
 }
 
 void
-Mesh::set_attrib(unsigned int pos, const LibMatrix::vec4 &v, std::vector<float> *vertex)
+Mesh::set_attrib(unsigned int pos, const LibMatrix::vec4 &v)
 {
     if (!check_attrib(pos, 4))
         return;
 
-    std::vector<float> &vtx = !vertex ? ensure_vertex() : *vertex;
+    float *dest = current_attrib(pos);
 
-    int offset = vertex_format_[pos].second;
-
-    vtx[offset] = v.x();
-    vtx[offset + 1] = v.y();
-    vtx[offset + 2] = v.z();
-    vtx[offset + 3] = v.w();
+    dest[0] = v.x();
+    dest[1] = v.y();
+    dest[2] = v.z();
+    dest[3] = v.w();
 }
 
 /*
- * Adds a new vertex to the list and makes it current.
+ * Adds a new vertex, with all values set to zero, and makes it current.
  */
 void
 Mesh::next_vertex()
 {
-    vertices_.push_back(std::vector<float>(vertex_size_));
+    /* Vertices can only be appended in the interleaved layout */
+    set_layout(true);
+
+    data_.resize(data_.size() + vertex_size_);
+    nvertices_++;
 }
 
 /**
@@ -187,13 +290,530 @@ Mesh::next_vertex()
  * You should use the ::set_attrib() method to manipulate
  * the vertex data.
  *
- * You shouldn't resize the vector (change the number of vertices)
- * manually. Use ::next_vertex() instead.
+ * The view is valid until vertices are added to the mesh.
  */
-std::vector<std::vector<float> >&
+Mesh::VertexView
 Mesh::vertices()
 {
-    return vertices_;
+    return VertexView(*this);
+}
+
+/**
+ * Adds an index to the index buffer, making the mesh indexed.
+ *
+ * Every three indices form a triangle.
+ *
+ * @param index the index of a vertex added with ::next_vertex()
+ */
+void
+Mesh::add_index(unsigned int index)
+{
+    indices_.push_back(index);
+}
+
+/**
+ * Reorders the triangles of an indexed mesh to improve the hit rate of the
+ * post-transform vertex cache, using the linear-speed vertex cache
+ * optimisation by Tom Forsyth, and then the vertices in order of first use
+ * to improve the locality of vertex fetches.
+ */
+void
+Mesh::optimize_vertex_cache()
+{
+    size_t ntriangles = indices_.size() / 3;
+
+    if (ntriangles == 0)
+        return;
+
+    /* The triangles using each vertex, of which the first remaining[v] haven't been added yet */
+    std::vector<unsigned int> remaining(nvertices_, 0);
+    std::vector<unsigned int> first_triangle(nvertices_ + 1, 0);
+    std::vector<unsigned int> vertex_triangles(indices_.size());
+
+    for (size_t i = 0; i < indices_.size(); i++)
+        remaining[indices_[i]]++;
+    for (size_t v = 0; v < nvertices_; v++)
+        first_triangle[v + 1] = first_triangle[v] + remaining[v];
+    std::fill(remaining.begin(), remaining.end(), 0);
+    for (size_t i = 0; i < indices_.size(); i++) {
+        unsigned int v = indices_[i];
+        vertex_triangles[first_triangle[v] + remaining[v]++] = i / 3;
+    }
+
+    std::vector<int> cache_pos(nvertices_, -1);
+    std::vector<float> vertex_score(nvertices_);
+    std::vector<float> triangle_score(ntriangles, 0.0f);
+    std::vector<bool> triangle_added(ntriangles, false);
+
+    for (size_t v = 0; v < nvertices_; v++) {
+        vertex_score[v] = vertex_cache_score(-1, remaining[v]);
+        for (unsigned int i = first_triangle[v]; i < first_triangle[v] + remaining[v]; i++)
+            triangle_score[vertex_triangles[i]] += vertex_score[v];
+    }
+
+    std::vector<unsigned int> cache;
+    std::vector<unsigned int> new_cache;
+    std::vector<unsigned int> new_indices;
+    new_indices.reserve(indices_.size());
+
+    long best = std::max_element(triangle_score.begin(), triangle_score.end()) -
+                triangle_score.begin();
+
+    for (size_t n = 0; n < ntriangles; n++) {
+        /* If no triangle of a cached vertex is left, start over with the best one */
+        if (best < 0) {
+            float best_score = -1.0f;
+            for (size_t t = 0; t < ntriangles; t++) {
+                if (!triangle_added[t] && triangle_score[t] > best_score) {
+                    best_score = triangle_score[t];
+                    best = t;
+                }
+            }
+        }
+
+        triangle_added[best] = true;
+        new_cache.clear();
+
+        for (int i = 0; i < 3; i++) {
+            unsigned int v = indices_[3 * best + i];
+            new_indices.push_back(v);
+            new_cache.push_back(v);
+
+            /* Move the triangle past the remaining ones of the vertex */
+            unsigned int *tris = &vertex_triangles[first_triangle[v]];
+            unsigned int *pos = std::find(tris, tris + remaining[v], static_cast<unsigned int>(best));
+            std::swap(*pos, tris[remaining[v] - 1]);
+            remaining[v]--;
+        }
+
+        for (auto v : cache) {
+            if (std::find(new_cache.begin(), new_cache.end(), v) == new_cache.end())
+                new_cache.push_back(v);
+        }
+
+        /* Update the scores of the cached vertices, and of the evicted ones */
+        best = -1;
+        float best_score = -1.0f;
+
+        for (size_t i = 0; i < new_cache.size(); i++) {
+            unsigned int v = new_cache[i];
+            cache_pos[v] = i < static_cast<size_t>(vertex_cache_size) ? i : -1;
+
+            float score = vertex_cache_score(cache_pos[v], remaining[v]);
+            float delta = score - vertex_score[v];
+            vertex_score[v] = score;
+
+            for (unsigned int j = first_triangle[v]; j < first_triangle[v] + remaining[v]; j++) {
+                unsigned int t = vertex_triangles[j];
+                triangle_score[t] += delta;
+                if (triangle_score[t] > best_score) {
+                    best_score = triangle_score[t];
+                    best = t;
+                }
+            }
+        }
+
+        if (new_cache.size() > static_cast<size_t>(vertex_cache_size))
+            new_cache.resize(vertex_cache_size);
+        cache.swap(new_cache);
+    }
+
+    /* Renumber the vertices in order of first use */
+    std::vector<unsigned int> order;
+    std::vector<int> new_index(nvertices_, -1);
+
+    order.reserve(nvertices_);
+    for (auto &index : new_indices) {
+        if (new_index[index] < 0) {
+            new_index[index] = order.size();
+            order.push_back(index);
+        }
+        index = new_index[index];
+    }
+
+    indices_.swap(new_indices);
+    reorder_vertices(order);
+}
+
+/**
+ * Rearranges the vertices, leaving them in the interleaved layout.
+ *
+ * @param order the old index of each new vertex (old vertices may be
+ *              repeated or dropped)
+ */
+void
+Mesh::reorder_vertices(const std::vector<unsigned int> &order)
+{
+    set_layout(true);
+
+    std::vector<float> data(order.size() * vertex_size_);
+
+    for (size_t i = 0; i < order.size(); i++) {
+        memcpy(&data[i * vertex_size_], &data_[order[i] * vertex_size_],
+               vertex_size_ * sizeof(float));
+    }
+
+    data_.swap(data);
+    nvertices_ = order.size();
+}
+
+/**
+ * Prepares the indices for drawing, using 16-bit indices when possible.
+ *
+ * If the mesh has too many vertices for 16-bit indices, and 32-bit indices
+ * are not supported, the triangles are expanded into separate vertices.
+ *
+ * @return whether the mesh is drawn with indices
+ */
+bool
+Mesh::prepare_indices()
+{
+    if (indices_.empty())
+        return false;
+
+    if (nvertices_ <= 65536) {
+        short_indices_.assign(indices_.begin(), indices_.end());
+        index_type_ = GL_UNSIGNED_SHORT;
+        return true;
+    }
+
+    short_indices_.clear();
+    index_type_ = GL_UNSIGNED_INT;
+
+#if GLMARK2_USE_GLESv2
+    if (!GLExtensions::support("GL_OES_element_index_uint")) {
+        Log::debug("32-bit indices are not supported, drawing without indices\n");
+        std::vector<unsigned int> order;
+        order.swap(indices_);
+        reorder_vertices(order);
+        return false;
+    }
+#endif
+
+    return true;
+}
+
+/**
+ * Draws the mesh triangles, with the vertex arrays or buffers already set
+ * up.
+ *
+ * @param index_data the index data, or the offset in the bound index buffer
+ */
+void
+Mesh::draw(const void *index_data)
+{
+    if (!indices_.empty())
+        glDrawElements(GL_TRIANGLES, indices_.size(), index_type_, index_data);
+    else
+        glDrawArrays(GL_TRIANGLES, 0, nvertices_);
+}
+
+/**
+ * Gets the vertex array object for the current attribute locations,
+ * recording it if needed.
+ *
+ * The VBOs must have been previously initialized using ::build_vbo().
+ *
+ * @return the vertex array object
+ */
+GLuint
+Mesh::vertex_array()
+{
+    for (size_t i = 0; i < vaos_.size(); i++) {
+        if (vaos_[i].first == attrib_locations_)
+            return vaos_[i].second;
+    }
+
+    GLuint vao;
+    GLExtensions::GenVertexArrays(1, &vao);
+    GLExtensions::BindVertexArray(vao);
+
+    for (size_t i = 0; i < vertex_format_.size(); i++) {
+        if (attrib_locations_[i] < 0)
+            continue;
+        glEnableVertexAttribArray(attrib_locations_[i]);
+        glBindBuffer(GL_ARRAY_BUFFER, vbos_[i]);
+        attrib_pointer(i);
+    }
+
+    /* The index buffer binding is part of the vertex array object */
+    if (ibo_)
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo_);
+
+    GLExtensions::BindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    if (ibo_)
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+    vaos_.push_back(std::pair<std::vector<int>, GLuint>(attrib_locations_, vao));
+
+    return vao;
+}
+
+/**
+ * Gets the data of an attribute of a vertex.
+ *
+ * The data of the same attribute for the next vertex starts
+ * ::attrib_stride() floats later.
+ *
+ * @param vertex the index of the vertex
+ * @param pos the position/index of the attribute
+ *
+ * @return the attribute data
+ */
+float *
+Mesh::attrib_data(size_t vertex, unsigned int pos)
+{
+    const std::pair<int, int> &attrib = vertex_format_[pos];
+
+    if (data_interleaved_)
+        return &data_[vertex * vertex_size_ + attrib.second];
+    else
+        return &data_[nvertices_ * attrib.second + vertex * attrib.first];
+}
+
+/**
+ * Gets the distance (in floats) between the data of an attribute for
+ * consecutive vertices.
+ *
+ * @param pos the position/index of the attribute
+ *
+ * @return the stride
+ */
+size_t
+Mesh::attrib_stride(unsigned int pos) const
+{
+    return data_interleaved_ ? vertex_size_ : vertex_format_[pos].first;
+}
+
+/**
+ * Gets a float value of a vertex, by its index in the vertex format.
+ */
+float &
+Mesh::component(size_t vertex, size_t i)
+{
+    unsigned int pos = component_attrib_[i];
+
+    return attrib_data(vertex, pos)[i - vertex_format_[pos].second];
+}
+
+/**
+ * Changes the layout of the vertex data.
+ *
+ * @param interleaved whether to use the interleaved layout
+ */
+void
+Mesh::set_layout(bool interleaved)
+{
+    if (data_interleaved_ == interleaved)
+        return;
+
+    if (nvertices_ == 0) {
+        data_interleaved_ = interleaved;
+        return;
+    }
+
+    std::vector<float> data(data_.size());
+
+    for (size_t pos = 0; pos < vertex_format_.size(); pos++) {
+        size_t dim = vertex_format_[pos].first;
+        size_t offset = vertex_format_[pos].second;
+        float *attrib = &data_[0] + (interleaved ? nvertices_ * offset : offset);
+        float *dest = &data[0] + (interleaved ? offset : nvertices_ * offset);
+        size_t src_stride = interleaved ? dim : vertex_size_;
+        size_t dest_stride = interleaved ? vertex_size_ : dim;
+
+        for (size_t v = 0; v < nvertices_; v++) {
+            memcpy(dest, attrib, dim * sizeof(float));
+            attrib += src_stride;
+            dest += dest_stride;
+        }
+    }
+
+    data_.swap(data);
+    data_interleaved_ = interleaved;
+}
+
+/**
+ * Gets the storage format to use for an attribute, falling back to wider
+ * formats if the requested one is not supported, or can't represent the
+ * attribute values.
+ *
+ * @param pos the position of the attribute in the vertex format
+ *
+ * @return the storage format
+ */
+Mesh::AttribFormat
+Mesh::supported_format(unsigned int pos)
+{
+    AttribFormat format = attrib_formats_[pos];
+    int dim = vertex_format_[pos].first;
+
+    if (format == AttribFormatInt2101010Rev &&
+        (dim < 3 || !GLExtensions::VertexType2101010Rev))
+    {
+        Log::debug("Mesh: using half floats instead of 2_10_10_10 for attribute %u\n", pos);
+        format = AttribFormatHalfFloat;
+    }
+
+    if (format == AttribFormatUnsignedShortNormalized) {
+        for (size_t v = 0; v < nvertices_; v++) {
+            const float *data = attrib_data(v, pos);
+            if (std::any_of(data, data + dim, [](float f) { return f < 0.0f || f > 1.0f; })) {
+                Log::debug("Mesh: using half floats instead of normalized shorts for"
+                           " attribute %u, which has values outside [0, 1]\n", pos);
+                format = AttribFormatHalfFloat;
+                break;
+            }
+        }
+    }
+
+    if (format == AttribFormatHalfFloat && !GLExtensions::HalfFloatVertexType) {
+        Log::debug("Mesh: using floats instead of half floats for attribute %u\n", pos);
+        format = AttribFormatFloat;
+    }
+
+    return format;
+}
+
+/**
+ * Sets up how the attributes are stored in the vertex arrays or VBOs.
+ *
+ * @return whether any attribute is stored in a compact format, so the
+ *         vertex data needs to be converted
+ */
+bool
+Mesh::set_attrib_storage()
+{
+    attrib_storage_.clear();
+    attribs_packed_ = false;
+    packed_stride_ = 0;
+
+    for (size_t i = 0; i < vertex_format_.size(); i++) {
+        AttribStorage storage;
+        int dim = vertex_format_[i].first;
+
+        storage.format = supported_format(i);
+        storage.size = dim;
+        storage.normalized = GL_FALSE;
+
+        if (storage.format == AttribFormatHalfFloat) {
+            storage.type = GLExtensions::HalfFloatVertexType;
+            storage.bytes = (dim * sizeof(uint16_t) + 3) & ~3;
+        }
+        else if (storage.format == AttribFormatUnsignedShortNormalized) {
+            storage.type = GL_UNSIGNED_SHORT;
+            storage.normalized = GL_TRUE;
+            storage.bytes = (dim * sizeof(uint16_t) + 3) & ~3;
+        }
+        else if (storage.format == AttribFormatInt2101010Rev) {
+            /* The size must be 4, with shaders reading vec3 attributes ignoring w */
+            storage.type = GL_INT_2_10_10_10_REV;
+            storage.size = 4;
+            storage.normalized = GL_TRUE;
+            storage.bytes = sizeof(uint32_t);
+        }
+        else {
+            storage.type = GL_FLOAT;
+            storage.bytes = dim * sizeof(float);
+        }
+
+        storage.offset = packed_stride_;
+        packed_stride_ += storage.bytes;
+        attribs_packed_ = attribs_packed_ || storage.format != AttribFormatFloat;
+        attrib_storage_.push_back(storage);
+    }
+
+    for (size_t i = 0; i < attrib_storage_.size(); i++)
+        attrib_storage_[i].stride = interleave_ ? packed_stride_ : attrib_storage_[i].bytes;
+
+    if (attribs_packed_) {
+        Log::debug("Mesh: %zu bytes per vertex instead of %zu\n",
+                   packed_stride_, vertex_size_ * sizeof(float));
+    }
+
+    return attribs_packed_;
+}
+
+/**
+ * Converts an attribute of a vertex to its storage format.
+ *
+ * @param pos the position of the attribute in the vertex format
+ * @param vertex the index of the vertex
+ * @param dest where to write the converted attribute
+ */
+void
+Mesh::pack_attrib(unsigned int pos, size_t vertex, unsigned char *dest)
+{
+    const AttribStorage &storage = attrib_storage_[pos];
+    const float *data = attrib_data(vertex, pos);
+    int dim = vertex_format_[pos].first;
+
+    if (storage.format == AttribFormatHalfFloat) {
+        uint16_t half[4];
+        for (int i = 0; i < dim; i++)
+            half[i] = float_to_half(data[i]);
+        memcpy(dest, half, dim * sizeof(uint16_t));
+    }
+    else if (storage.format == AttribFormatUnsignedShortNormalized) {
+        uint16_t value[4];
+        for (int i = 0; i < dim; i++)
+            value[i] = lrintf(std::clamp(data[i], 0.0f, 1.0f) * 65535.0f);
+        memcpy(dest, value, dim * sizeof(uint16_t));
+    }
+    else if (storage.format == AttribFormatInt2101010Rev) {
+        uint32_t value = 0;
+        for (int i = 0; i < 3; i++) {
+            int32_t c = lrintf(std::clamp(data[i], -1.0f, 1.0f) * 511.0f);
+            value |= (static_cast<uint32_t>(c) & 0x3ff) << (10 * i);
+        }
+        if (dim > 3) {
+            int32_t w = lrintf(std::clamp(data[3], -1.0f, 1.0f));
+            value |= (static_cast<uint32_t>(w) & 0x3) << 30;
+        }
+        memcpy(dest, &value, sizeof(value));
+    }
+    else {
+        memcpy(dest, data, dim * sizeof(float));
+    }
+}
+
+/**
+ * Converts a range of vertices to the attribute storage formats.
+ *
+ * @param first the first vertex to convert
+ * @param count the number of vertices to convert
+ * @param pos the attribute to convert, or -1 to convert all attributes into
+ *            interleaved vertices
+ * @param dest where to write the converted vertices
+ */
+void
+Mesh::pack_vertices(size_t first, size_t count, int pos, unsigned char *dest)
+{
+    for (size_t v = 0; v < count; v++) {
+        if (pos >= 0) {
+            pack_attrib(pos, first + v, dest + v * attrib_storage_[pos].bytes);
+            continue;
+        }
+
+        for (size_t i = 0; i < attrib_storage_.size(); i++)
+            pack_attrib(i, first + v, dest + v * packed_stride_ + attrib_storage_[i].offset);
+    }
+}
+
+/**
+ * Sets the pointer of an attribute to the built vertex arrays, or the
+ * bound VBO.
+ *
+ * @param pos the position of the attribute in the vertex format
+ */
+void
+Mesh::attrib_pointer(unsigned int pos)
+{
+    const AttribStorage &storage = attrib_storage_[pos];
+
+    glVertexAttribPointer(attrib_locations_[pos], storage.size, storage.type,
+                          storage.normalized, storage.stride, attrib_data_ptr_[pos]);
 }
 
 /**
@@ -238,6 +858,22 @@ Mesh::interleave(bool interleave)
     interleave_ = interleave;
 }
 
+/**
+ * Sets whether to render VBOs through vertex array objects.
+ *
+ * If true, the attribute setup is recorded in a vertex array object, so
+ * each ::render_vbo() only binds that object. Otherwise every
+ * ::render_vbo() sets up and tears down each attribute. Vertex array
+ * objects are only used if the GL supports them.
+ *
+ * @param use_vao whether to use vertex array objects
+ */
+void
+Mesh::use_vao(bool use_vao)
+{
+    use_vao_ = use_vao;
+}
+
 /**
  * Resets a Mesh object to its initial, empty state.
  */
@@ -247,12 +883,21 @@ Mesh::reset()
     delete_array();
     delete_vbo();
 
-    vertices_.clear();
+    std::vector<float>().swap(data_);
+    std::vector<unsigned int>().swap(indices_);
+    std::vector<GLushort>().swap(short_indices_);
+    nvertices_ = 0;
+    data_interleaved_ = true;
     vertex_format_.clear();
+    component_attrib_.clear();
     attrib_locations_.clear();
     attrib_data_ptr_.clear();
+    attrib_formats_.clear();
+    attrib_storage_.clear();
+    std::vector<unsigned char>().swap(packed_data_);
     vertex_size_ = 0;
-    vertex_stride_ = 0;
+    packed_stride_ = 0;
+    attribs_packed_ = false;
 }
 
 /**
@@ -260,54 +905,43 @@ Mesh::reset()
  *
  * The way the vertex array is constructed is affected by the current
  * interleave value, which can set using ::interleave().
+ *
+ * The vertex arrays point directly to the mesh vertex data, so changes to
+ * the data are visible to them without further updates, as long as no
+ * vertices are added.
  */
 void
 Mesh::build_array()
 {
-    int nvertices = vertices_.size();
+    prepare_indices();
+    set_layout(interleave_);
 
-    if (!interleave_) {
-        /* Create an array for each attribute */
-        for (std::vector<std::pair<int, int> >::const_iterator ai = vertex_format_.begin();
-             ai != vertex_format_.end();
-             ai++)
-        {
-            float *array = new float[nvertices * ai->first];
-            float *cur = array;
-
-            /* Fill in the array */
-            for (std::vector<std::vector<float> >::const_iterator vi = vertices_.begin();
-                    vi != vertices_.end();
-                    vi++)
-            {
-                for (int i = 0; i < ai->first; i++)
-                    *cur++ = (*vi)[ai->second + i];
-            }
+    attrib_data_ptr_.clear();
 
-            vertex_arrays_.push_back(array);
-            attrib_data_ptr_.push_back(array);
+    if (!set_attrib_storage()) {
+        std::vector<unsigned char>().swap(packed_data_);
+        for (size_t i = 0; i < vertex_format_.size(); i++)
+            attrib_data_ptr_.push_back(nvertices_ > 0 ? attrib_data(0, i) : 0);
+    }
+    else if (interleave_) {
+        packed_data_.assign(nvertices_ * packed_stride_, 0);
+        pack_vertices(0, nvertices_, -1, packed_data_.data());
+        for (size_t i = 0; i < attrib_storage_.size(); i++) {
+            attrib_data_ptr_.push_back(
+                reinterpret_cast<float *>(packed_data_.data() + attrib_storage_[i].offset));
         }
-        vertex_stride_ = 0;
     }
     else {
-        float *array = new float[nvertices * vertex_size_];
-        float *cur = array;
-
-        for (std::vector<std::vector<float> >::const_iterator vi = vertices_.begin();
-             vi != vertices_.end();
-             vi++)
-        {
-            /* Fill in the array */
-            for (int i = 0; i < vertex_size_; i++)
-                *cur++ = (*vi)[i];
+        packed_data_.assign(nvertices_ * packed_stride_, 0);
+        unsigned char *data = packed_data_.data();
+        for (size_t i = 0; i < attrib_storage_.size(); i++) {
+            pack_vertices(0, nvertices_, i, data);
+            attrib_data_ptr_.push_back(reinterpret_cast<float *>(data));
+            data += nvertices_ * attrib_storage_[i].bytes;
         }
-
-        for (size_t i = 0; i < vertex_format_.size(); i++)
-            attrib_data_ptr_.push_back(array + vertex_format_[i].second);
-
-        vertex_arrays_.push_back(array);
-        vertex_stride_ = vertex_size_ * sizeof(float);
     }
+
+    arrays_built_ = true;
 }
 
 /**
@@ -315,14 +949,15 @@ Mesh::build_array()
  *
  * The way the VBO is constructed is affected by the current interleave
  * value (::interleave()) and the vbo usage hint (::vbo_usage()).
+ *
+ * The VBOs are filled directly from the mesh vertex data.
  */
 void
 Mesh::build_vbo()
 {
     delete_array();
-    build_array();
-
-    int nvertices = vertices_.size();
+    bool indexed = prepare_indices();
+    set_layout(interleave_);
 
     attrib_data_ptr_.clear();
 
@@ -334,101 +969,118 @@ Mesh::build_vbo()
     else /* if (vbo_usage_ == Mesh::VBOUsageStatic) */
         buffer_usage = GL_STATIC_DRAW;
 
+    /* Data in compact formats is converted into a temporary buffer */
+    bool packed = set_attrib_storage();
+    std::vector<unsigned char> packed_data;
+
+    if (packed)
+        packed_data.resize(nvertices_ * packed_stride_);
+
     if (!interleave_) {
         /* Create a vbo for each attribute */
-        for (std::vector<std::pair<int, int> >::const_iterator ai = vertex_format_.begin();
-             ai != vertex_format_.end();
-             ai++)
-        {
-            float *data = vertex_arrays_[ai - vertex_format_.begin()];
+        for (size_t i = 0; i < vertex_format_.size(); i++) {
+            const void *data = data_.data() + nvertices_ * vertex_format_[i].second;
             GLuint vbo;
 
+            if (packed) {
+                pack_vertices(0, nvertices_, i, packed_data.data());
+                data = packed_data.data();
+            }
+
             glGenBuffers(1, &vbo);
             glBindBuffer(GL_ARRAY_BUFFER, vbo);
-            glBufferData(GL_ARRAY_BUFFER, nvertices * ai->first * sizeof(float),
+            glBufferData(GL_ARRAY_BUFFER, nvertices_ * attrib_storage_[i].bytes,
                          data, buffer_usage);
 
             vbos_.push_back(vbo);
             attrib_data_ptr_.push_back(0);
         }
-
-        vertex_stride_ = 0;
     }
     else {
+        const void *data = data_.data();
         GLuint vbo;
+
+        if (packed) {
+            pack_vertices(0, nvertices_, -1, packed_data.data());
+            data = packed_data.data();
+        }
+
         /* Create a single vbo to store all attribute data */
         glGenBuffers(1, &vbo);
         glBindBuffer(GL_ARRAY_BUFFER, vbo);
 
-        glBufferData(GL_ARRAY_BUFFER, nvertices * vertex_size_ * sizeof(float),
-                     vertex_arrays_[0], GL_STATIC_DRAW);
-
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glBufferData(GL_ARRAY_BUFFER, nvertices_ * packed_stride_, data, GL_STATIC_DRAW);
 
         for (size_t i = 0; i < vertex_format_.size(); i++) {
-            attrib_data_ptr_.push_back(reinterpret_cast<float *>(sizeof(float) * vertex_format_[i].second));
+            attrib_data_ptr_.push_back(reinterpret_cast<float *>(attrib_storage_[i].offset));
             vbos_.push_back(vbo);
         }
-        vertex_stride_ = vertex_size_ * sizeof(float);
     }
 
-    delete_array();
-}
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
 
-/**
- * Updates ranges of a single vertex array.
- *
- * @param ranges the ranges of vertices to update
- * @param n the index of the vertex array to update
- * @param nfloats how many floats to update for each vertex
- * @param offset the offset (in floats) in the vertex data to start reading from
- */
-void
-Mesh::update_single_array(const std::vector<std::pair<size_t, size_t> >& ranges,
-                          size_t n, size_t nfloats, size_t offset)
-{
-    float *array(vertex_arrays_[n]);
+    if (indexed) {
+        const void *data = short_indices_.empty() ?
+                           static_cast<const void *>(indices_.data()) : short_indices_.data();
+        size_t size = short_indices_.empty() ? indices_.size() * sizeof(unsigned int) :
+                                               short_indices_.size() * sizeof(GLushort);
 
-    /* Update supplied ranges */
-    for (std::vector<std::pair<size_t, size_t> >::const_iterator ri = ranges.begin();
-         ri != ranges.end();
-         ri++)
-    {
-        /* Update the current range from the vertex data */
-        float *dest(array + nfloats * ri->first);
-        for (size_t n = ri->first; n <= ri->second; n++) {
-            float *src(vertices_[n].data() + offset);
-            std::copy(src, src + nfloats, dest);
-            dest += nfloats;
-        }
+        glGenBuffers(1, &ibo_);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo_);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, size, data, GL_STATIC_DRAW);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+        /* The index buffer has its own copy */
+        std::vector<GLushort>().swap(short_indices_);
+    }
 
+    /* Record the vertex array object now if the attribute locations are known */
+    if (use_vao_ && GLExtensions::GenVertexArrays &&
+        attrib_locations_.size() == vertex_format_.size())
+    {
+        vertex_array();
     }
 }
 
 /**
  * Updates ranges of the vertex arrays.
  *
+ * The vertex arrays use the mesh vertex data directly, so this only builds
+ * them if they haven't been built yet.
+ *
  * @param ranges the ranges of vertices to update
  */
 void
 Mesh::update_array(const std::vector<std::pair<size_t, size_t> >& ranges)
 {
     /* If we don't have arrays to update, create them */
-    if (vertex_arrays_.empty()) {
+    if (!arrays_built_) {
         build_array();
         return;
     }
 
-    if (!interleave_) {
-        for (size_t i = 0; i < vertex_arrays_.size(); i++) {
-            update_single_array(ranges, i, vertex_format_[i].first,
-                                vertex_format_[i].second);
+    if (!attribs_packed_)
+        return;
+
+    /* Convert the updated vertices to the compact formats again */
+    for (std::vector<std::pair<size_t, size_t> >::const_iterator iter = ranges.begin();
+         iter != ranges.end();
+         iter++)
+    {
+        size_t count = iter->second + 1 - iter->first;
+
+        if (interleave_) {
+            pack_vertices(iter->first, count, -1,
+                          packed_data_.data() + iter->first * packed_stride_);
+            continue;
         }
-    }
-    else {
-        update_single_array(ranges, 0, vertex_size_, 0);
-    }
 
+        for (size_t i = 0; i < attrib_storage_.size(); i++) {
+            unsigned char *data = reinterpret_cast<unsigned char *>(attrib_data_ptr_[i]);
+            pack_vertices(iter->first, count, i,
+                          data + iter->first * attrib_storage_[i].bytes);
+        }
+    }
 }
 
 
@@ -441,12 +1093,13 @@ Mesh::update_array(const std::vector<std::pair<size_t, size_t> >& ranges)
  * @param ranges the ranges of vertices to update
  * @param n the index of the vbo to update
  * @param nfloats how many floats to update for each vertex
+ * @param offset the offset (in floats) of the VBO data in the vertex data
  */
 void
 Mesh::update_single_vbo(const std::vector<std::pair<size_t, size_t> >& ranges,
-                        size_t n, size_t nfloats)
+                        size_t n, size_t nfloats, size_t offset)
 {
-    float *src_start(vertex_arrays_[n]);
+    const float *src_start(data_.data() + offset);
     float *dest_start(0);
 
     glBindBuffer(GL_ARRAY_BUFFER, vbos_[n]);
@@ -462,16 +1115,16 @@ Mesh::update_single_vbo(const std::vector<std::pair<size_t, size_t> >& ranges,
          iter != ranges.end();
          iter++)
     {
-        float *src(src_start + nfloats * iter->first);
-        float *src_end(src_start + nfloats * (iter->second + 1));
+        const float *src(src_start + nfloats * iter->first);
+        size_t size((iter->second + 1 - iter->first) * nfloats * sizeof(float));
 
         if (vbo_update_method_ == VBOUpdateMethodMap) {
             float *dest(dest_start + nfloats * iter->first);
-            std::copy(src, src_end, dest);
+            memcpy(dest, src, size);
         }
         else if (vbo_update_method_ == VBOUpdateMethodSubData) {
             glBufferSubData(GL_ARRAY_BUFFER, nfloats * iter->first * sizeof(float),
-                            (src_end - src) * sizeof(float), src);
+                            size, src);
         }
     }
 
@@ -493,14 +1146,39 @@ Mesh::update_vbo(const std::vector<std::pair<size_t, size_t> >& ranges)
         return;
     }
 
-    update_array(ranges);
+    if (attribs_packed_) {
+        /* Convert the updated vertices to the compact formats again */
+        std::vector<unsigned char> data;
 
-    if (!interleave_) {
-        for (size_t i = 0; i < vbos_.size(); i++)
-            update_single_vbo(ranges, i, vertex_format_[i].first);
+        for (std::vector<std::pair<size_t, size_t> >::const_iterator iter = ranges.begin();
+             iter != ranges.end();
+             iter++)
+        {
+            size_t count = iter->second + 1 - iter->first;
+
+            for (size_t i = 0; i < vbos_.size(); i++) {
+                size_t bytes = interleave_ ? packed_stride_ : attrib_storage_[i].bytes;
+
+                data.assign(count * bytes, 0);
+                pack_vertices(iter->first, count, interleave_ ? -1 : i, data.data());
+
+                glBindBuffer(GL_ARRAY_BUFFER, vbos_[i]);
+                glBufferSubData(GL_ARRAY_BUFFER, iter->first * bytes, data.size(), data.data());
+
+                /* All attributes share the same VBO */
+                if (interleave_)
+                    break;
+            }
+        }
+    }
+    else if (!interleave_) {
+        for (size_t i = 0; i < vbos_.size(); i++) {
+            update_single_vbo(ranges, i, vertex_format_[i].first,
+                              nvertices_ * vertex_format_[i].second);
+        }
     }
     else {
-        update_single_vbo(ranges, 0, vertex_size_);
+        update_single_vbo(ranges, 0, vertex_size_, 0);
     }
 
     glBindBuffer(GL_ARRAY_BUFFER, 0);
@@ -513,11 +1191,7 @@ Mesh::update_vbo(const std::vector<std::pair<size_t, size_t> >& ranges)
 void
 Mesh::delete_array()
 {
-    for (size_t i = 0; i < vertex_arrays_.size(); i++) {
-        delete [] vertex_arrays_[i];
-    }
-
-    vertex_arrays_.clear();
+    arrays_built_ = false;
 }
 
 /**
@@ -532,6 +1206,16 @@ Mesh::delete_vbo()
     }
 
     vbos_.clear();
+
+    if (ibo_) {
+        glDeleteBuffers(1, &ibo_);
+        ibo_ = 0;
+    }
+
+    for (size_t i = 0; i < vaos_.size(); i++)
+        GLExtensions::DeleteVertexArrays(1, &vaos_[i].second);
+
+    vaos_.clear();
 }
 
 
@@ -548,12 +1232,13 @@ Mesh::render_array()
         if (attrib_locations_[i] < 0)
             continue;
         glEnableVertexAttribArray(attrib_locations_[i]);
-        glVertexAttribPointer(attrib_locations_[i], vertex_format_[i].first,
-                              GL_FLOAT, GL_FALSE, vertex_stride_,
-                              attrib_data_ptr_[i]);
+        attrib_pointer(i);
     }
 
-    glDrawArrays(GL_TRIANGLES, 0, vertices_.size());
+    if (short_indices_.empty())
+        draw(indices_.data());
+    else
+        draw(short_indices_.data());
 
     for (size_t i = 0; i < vertex_format_.size(); i++) {
         if (attrib_locations_[i] < 0)
@@ -571,17 +1256,28 @@ Mesh::render_array()
 void
 Mesh::render_vbo()
 {
+    if (use_vao_ && GLExtensions::BindVertexArray) {
+        GLExtensions::BindVertexArray(vertex_array());
+        draw(0);
+        GLExtensions::BindVertexArray(0);
+        return;
+    }
+
     for (size_t i = 0; i < vertex_format_.size(); i++) {
         if (attrib_locations_[i] < 0)
             continue;
         glEnableVertexAttribArray(attrib_locations_[i]);
         glBindBuffer(GL_ARRAY_BUFFER, vbos_[i]);
-        glVertexAttribPointer(attrib_locations_[i], vertex_format_[i].first,
-                              GL_FLOAT, GL_FALSE, vertex_stride_,
-                              attrib_data_ptr_[i]);
+        attrib_pointer(i);
     }
 
-    glDrawArrays(GL_TRIANGLES, 0, vertices_.size());
+    if (ibo_)
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo_);
+
+    draw(0);
+
+    if (ibo_)
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 
     for (size_t i = 0; i < vertex_format_.size(); i++) {
         if (attrib_locations_[i] < 0)
@@ -607,6 +1303,9 @@ Mesh::make_grid(int n_x, int n_y, double width, double height,
     double side_width = (width - (n_x - 1) * spacing) / n_x;
     double side_height = (height - (n_y - 1) * spacing) / n_y;
 
+    /* Grid configuration functions usually add two triangles per cell */
+    reserve_vertices(nvertices_ + 6 * n_x * n_y);
+
     for (int i = 0; i < n_x; i++) {
         for (int j = 0; j < n_y; j++) {
             LibMatrix::vec3 a(-width / 2 + i * (side_width + spacing),
@@ -616,22 +1315,12 @@ Mesh::make_grid(int n_x, int n_y, double width, double height,
             LibMatrix::vec3 d(a.x() + side_width, a.y() - side_height, 0);
 
             if (!conf_func) {
-                std::vector<float> ul(vertex_size_);
-                std::vector<float> ur(vertex_size_);
-                std::vector<float> ll(vertex_size_);
-                std::vector<float> lr(vertex_size_);
-
-                set_attrib(0, a, &ul);
-                set_attrib(0, c, &ur);
-                set_attrib(0, b, &ll);
-                set_attrib(0, d, &lr);
-
-                next_vertex(); vertices_.back() = ul;
-                next_vertex(); vertices_.back() = ll;
-                next_vertex(); vertices_.back() = ur;
-                next_vertex(); vertices_.back() = ll;
-                next_vertex(); vertices_.back() = lr;
-                next_vertex(); vertices_.back() = ur;
+                next_vertex(); set_attrib(0, a);
+                next_vertex(); set_attrib(0, b);
+                next_vertex(); set_attrib(0, c);
+                next_vertex(); set_attrib(0, b);
+                next_vertex(); set_attrib(0, d);
+                next_vertex(); set_attrib(0, c);
             }
             else {
                 conf_func(*this, i, j, n_x, n_y, a, b, c, d);
@@ -25,6 +25,7 @@
 #ifndef GLMARK2_MESH_H_
 #define GLMARK2_MESH_H_
 
+#include <cstddef>
 #include <utility>
 #include <vector>
 #include "vec.h"
@@ -32,21 +33,81 @@
 
 /**
  * A mesh of vertices.
+ *
+ * The vertex data is kept in a single contiguous buffer, either interleaved
+ * (all the attributes of a vertex together) or per-attribute (the values of
+ * each attribute for all vertices together), matching the layout of the
+ * vertex arrays or VBOs built from it, so building them doesn't need any
+ * intermediate copies.
+ *
+ * A mesh can optionally be indexed, with triangles referring to shared
+ * vertices through an index buffer.
+ *
+ * Attributes can be stored in the vertex arrays or VBOs in more compact
+ * formats than floats, in which case the vertex data is converted when they
+ * are built.
  */
 class Mesh
 {
 public:
+    /**
+     * A reference to the data of a vertex, as accessed through ::vertices().
+     */
+    class VertexRef
+    {
+    public:
+        VertexRef(Mesh &mesh, size_t vertex) : mesh_(mesh), vertex_(vertex) {}
+        float &operator[](size_t i) const { return mesh_.component(vertex_, i); }
+    private:
+        Mesh &mesh_;
+        size_t vertex_;
+    };
+
+    /**
+     * A view of the vertex data as an array of vertices, each one an array
+     * of floats in the order of the vertex format, regardless of the storage
+     * layout.
+     */
+    class VertexView
+    {
+    public:
+        VertexView(Mesh &mesh) : mesh_(mesh) {}
+        size_t size() const { return mesh_.nvertices_; }
+        bool empty() const { return mesh_.nvertices_ == 0; }
+        VertexRef operator[](size_t vertex) const { return VertexRef(mesh_, vertex); }
+    private:
+        Mesh &mesh_;
+    };
+
+    enum AttribFormat {
+        AttribFormatFloat,
+        AttribFormatHalfFloat,
+        AttribFormatUnsignedShortNormalized,
+        AttribFormatInt2101010Rev,
+    };
+
     Mesh();
     ~Mesh();
 
-    void set_vertex_format(const std::vector<int> &format);
+    void set_vertex_format(const std::vector<int> &format,
+                           const std::vector<AttribFormat> &storage = std::vector<AttribFormat>());
     void set_attrib_locations(const std::vector<int> &locations);
 
-    void set_attrib(unsigned int pos, const LibMatrix::vec2 &v, std::vector<float> *vertex = 0);
-    void set_attrib(unsigned int pos, const LibMatrix::vec3 &v, std::vector<float> *vertex = 0);
-    void set_attrib(unsigned int pos, const LibMatrix::vec4 &v, std::vector<float> *vertex = 0);
+    void reserve_vertices(size_t nvertices);
+    void set_attrib(unsigned int pos, const LibMatrix::vec2 &v);
+    void set_attrib(unsigned int pos, const LibMatrix::vec3 &v);
+    void set_attrib(unsigned int pos, const LibMatrix::vec4 &v);
     void next_vertex();
-    std::vector<std::vector<float> >& vertices();
+    VertexView vertices();
+
+    void add_index(unsigned int index);
+    const std::vector<unsigned int> &indices() const { return indices_; }
+    bool indexed() const { return !indices_.empty(); }
+    void optimize_vertex_cache();
+
+    size_t num_vertices() const { return nvertices_; }
+    float *attrib_data(size_t vertex, unsigned int pos);
+    size_t attrib_stride(unsigned int pos) const;
 
     enum VBOUpdateMethod {
         VBOUpdateMethodMap,
@@ -61,6 +122,7 @@ public:
     void vbo_update_method(VBOUpdateMethod method);
     void vbo_usage(VBOUsage usage);
     void interleave(bool interleave);
+    void use_vao(bool use_vao);
 
     void reset();
     void build_array();
@@ -84,11 +146,20 @@ public:
 
 private:
     bool check_attrib(unsigned int pos, int dim);
-    std::vector<float> &ensure_vertex();
-    void update_single_array(const std::vector<std::pair<size_t, size_t> >& ranges,
-                             size_t n, size_t nfloats, size_t offset);
+    float *current_attrib(unsigned int pos);
+    float &component(size_t vertex, size_t i);
+    void set_layout(bool interleaved);
+    AttribFormat supported_format(unsigned int pos);
+    bool set_attrib_storage();
+    void pack_attrib(unsigned int pos, size_t vertex, unsigned char *dest);
+    void pack_vertices(size_t first, size_t count, int pos, unsigned char *dest);
+    void attrib_pointer(unsigned int pos);
+    void reorder_vertices(const std::vector<unsigned int> &order);
+    bool prepare_indices();
+    void draw(const void *index_data);
+    GLuint vertex_array();
     void update_single_vbo(const std::vector<std::pair<size_t, size_t> >& ranges,
-                           size_t n, size_t nfloats);
+                           size_t n, size_t nfloats, size_t offset);
 
     //
     // vertex_format_ is a vector of pairs describing the attribute data.
@@ -101,18 +172,60 @@ private:
     // the size of a float, or: 8 * sizeof(float) == 32 bytes
     //
     std::vector<std::pair<int, int> > vertex_format_;
+    // The attribute of each float value of a vertex
+    std::vector<unsigned int> component_attrib_;
     std::vector<int> attrib_locations_;
     int vertex_size_;
 
-    std::vector<std::vector<float> > vertices_;
+    //
+    // The vertex data. In the interleaved layout, the data of vertex v
+    // starts at v * vertex_size_. In the per-attribute layout, the data of
+    // the attribute with offset o and dimension d for vertex v starts at
+    // nvertices_ * o + v * d.
+    //
+    std::vector<float> data_;
+    size_t nvertices_;
+    bool data_interleaved_;
+
+    // How each attribute is stored in the vertex arrays or VBOs
+    struct AttribStorage {
+        AttribFormat format;
+        GLenum type;
+        GLint size;
+        GLboolean normalized;
+        // The size of the attribute of a vertex, padded to 4 bytes
+        size_t bytes;
+        // The offset of the attribute in an interleaved vertex
+        size_t offset;
+        GLsizei stride;
+    };
+    std::vector<AttribFormat> attrib_formats_;
+    std::vector<AttribStorage> attrib_storage_;
+    // The size of an interleaved vertex in the compact formats
+    size_t packed_stride_;
+    // Whether any attribute is stored in a compact format
+    bool attribs_packed_;
+    // The vertex data converted to the compact formats, for vertex arrays
+    std::vector<unsigned char> packed_data_;
+
+    // Triangle vertex indices, empty for non-indexed meshes
+    std::vector<unsigned int> indices_;
+    // 16-bit copy of the indices, used for drawing meshes with few vertices
+    std::vector<GLushort> short_indices_;
+    GLenum index_type_;
+    GLuint ibo_;
 
-    std::vector<float *> vertex_arrays_;
+    bool arrays_built_;
     std::vector<GLuint> vbos_;
     std::vector<float *> attrib_data_ptr_;
-    int vertex_stride_;
     bool interleave_;
     VBOUpdateMethod vbo_update_method_;
     VBOUsage vbo_usage_;
+
+    // Vertex array objects recording the VBO setup, one for each set of
+    // attribute locations the mesh has been drawn with
+    bool use_vao_;
+    std::vector<std::pair<std::vector<int>, GLuint> > vaos_;
 };
 
 #endif
@@ -0,0 +1,318 @@
+/*
+ * Copyright © 2026 Collabora Limited
+ *
+ * This file is part of the glmark2 OpenGL (ES) 2.0 benchmark.
+ *
+ * glmark2 is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * glmark2 is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * glmark2.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "metrics-exporter.h"
+#include "log.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+namespace
+{
+
+/* The upper bounds of the frame time histogram buckets, in seconds */
+const double bucket_bounds[] = {
+    0.0005, 0.001, 0.002, 0.004, 0.008, 0.0125, 0.0167, 0.025,
+    0.0333, 0.05, 0.1, 0.25, 0.5, 1.0
+};
+const size_t bucket_count = sizeof(bucket_bounds) / sizeof(*bucket_bounds);
+
+struct BenchmarkMetrics {
+    std::string scene;
+    /* Updated at the end of each run, while holding metrics_mutex */
+    uint64_t iterations = 0;
+    uint64_t failures = 0;
+    bool have_stats = false;
+    double fps = 0.0;
+    double frame_time_p50 = 0.0;
+    double frame_time_p90 = 0.0;
+    double frame_time_p99 = 0.0;
+    double cpu_busy = 0.0;
+    /*
+     * Updated for every frame by the main thread only, without locking.
+     * The last bucket counts frames longer than the largest bound.
+     */
+    std::atomic<uint64_t> buckets[bucket_count + 1] = {};
+    std::atomic<double> frame_time_sum{0.0};
+};
+
+std::mutex metrics_mutex;
+std::condition_variable metrics_cv;
+std::map<std::string, BenchmarkMetrics> metrics;
+BenchmarkMetrics *current = nullptr;
+std::string metrics_file;
+std::chrono::milliseconds metrics_interval;
+bool metrics_stop = false;
+std::thread metrics_thread;
+
+std::string
+label_escape(const std::string &str)
+{
+    std::string escaped;
+
+    for (auto c : str) {
+        if (c == '\\' || c == '"')
+            escaped += '\\';
+        if (c == '\n')
+            escaped += "\\n";
+        else
+            escaped += c;
+    }
+
+    return escaped;
+}
+
+std::string
+format_value(double value)
+{
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%.9g", value);
+    return buf;
+}
+
+void
+write_header(std::ostream &os, const char *name, const char *type, const char *help)
+{
+    os << "# HELP " << name << " " << help << "\n";
+    os << "# TYPE " << name << " " << type << "\n";
+}
+
+/* Must be called while holding metrics_mutex */
+std::string
+format_metrics()
+{
+    std::stringstream ss;
+    std::map<std::string, std::string> labels;
+
+    for (auto const& m : metrics) {
+        labels[m.first] = "scene=\"" + label_escape(m.second.scene) +
+                          "\",benchmark=\"" + label_escape(m.first) + "\"";
+    }
+
+    write_header(ss, "glmark2_iterations_total", "counter",
+                 "Number of completed runs of the benchmark");
+    for (auto const& m : metrics)
+        ss << "glmark2_iterations_total{" << labels[m.first] << "} " << m.second.iterations << "\n";
+
+    write_header(ss, "glmark2_failures_total", "counter",
+                 "Number of runs of the benchmark that failed or were unsupported");
+    for (auto const& m : metrics)
+        ss << "glmark2_failures_total{" << labels[m.first] << "} " << m.second.failures << "\n";
+
+    write_header(ss, "glmark2_fps", "gauge",
+                 "Average FPS of the last run of the benchmark");
+    for (auto const& m : metrics) {
+        if (m.second.have_stats)
+            ss << "glmark2_fps{" << labels[m.first] << "} " << format_value(m.second.fps) << "\n";
+    }
+
+    write_header(ss, "glmark2_frame_time_quantile_seconds", "gauge",
+                 "Frame time quantiles of the last run of the benchmark");
+    for (auto const& m : metrics) {
+        if (!m.second.have_stats)
+            continue;
+        const std::string &l = labels[m.first];
+        ss << "glmark2_frame_time_quantile_seconds{" << l << ",quantile=\"0.5\"} "
+           << format_value(m.second.frame_time_p50) << "\n";
+        ss << "glmark2_frame_time_quantile_seconds{" << l << ",quantile=\"0.9\"} "
+           << format_value(m.second.frame_time_p90) << "\n";
+        ss << "glmark2_frame_time_quantile_seconds{" << l << ",quantile=\"0.99\"} "
+           << format_value(m.second.frame_time_p99) << "\n";
+    }
+
+    write_header(ss, "glmark2_cpu_busy_ratio", "gauge",
+                 "CPU busy ratio during the last run of the benchmark");
+    for (auto const& m : metrics) {
+        if (m.second.have_stats)
+            ss << "glmark2_cpu_busy_ratio{" << labels[m.first] << "} "
+               << format_value(m.second.cpu_busy) << "\n";
+    }
+
+    write_header(ss, "glmark2_frame_time_seconds", "histogram",
+                 "Frame times of all runs of the benchmark");
+    for (auto const& m : metrics) {
+        const std::string &l = labels[m.first];
+        uint64_t cumulative = 0;
+
+        for (size_t i = 0; i <= bucket_count; i++) {
+            cumulative += m.second.buckets[i].load(std::memory_order_relaxed);
+            std::string le = i < bucket_count ? format_value(bucket_bounds[i]) : "+Inf";
+            ss << "glmark2_frame_time_seconds_bucket{" << l << ",le=\"" << le << "\"} "
+               << cumulative << "\n";
+        }
+        ss << "glmark2_frame_time_seconds_sum{" << l << "} "
+           << format_value(m.second.frame_time_sum.load(std::memory_order_relaxed)) << "\n";
+        ss << "glmark2_frame_time_seconds_count{" << l << "} " << cumulative << "\n";
+    }
+
+    write_header(ss, "glmark2_last_update_timestamp_seconds", "gauge",
+                 "Time of the last update of the metrics");
+    ss << "glmark2_last_update_timestamp_seconds "
+       << format_value(std::chrono::duration<double>(
+              std::chrono::system_clock::now().time_since_epoch()).count())
+       << "\n";
+
+    return ss.str();
+}
+
+/* Writes to a temporary file and renames it, so readers never see a partial file */
+bool
+write_metrics(const std::string &text)
+{
+    std::string tmp_file = metrics_file + ".tmp";
+
+    {
+        std::ofstream ofs(tmp_file);
+        ofs << text;
+        if (!ofs) {
+            Log::error("Failed to write metrics file %s\n", tmp_file.c_str());
+            return false;
+        }
+    }
+
+    if (std::rename(tmp_file.c_str(), metrics_file.c_str()) != 0) {
+        Log::error("Failed to rename %s to %s\n", tmp_file.c_str(), metrics_file.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+void
+run_metrics_thread()
+{
+    std::unique_lock<std::mutex> lock(metrics_mutex);
+
+    while (!metrics_stop) {
+        metrics_cv.wait_for(lock, metrics_interval);
+        if (metrics_stop)
+            break;
+
+        std::string text = format_metrics();
+
+        /* Don't hold the lock during file I/O */
+        lock.unlock();
+        write_metrics(text);
+        lock.lock();
+    }
+}
+
+}
+
+bool MetricsExporter::enabled_ = false;
+
+bool
+MetricsExporter::init(const std::string &file, double interval)
+{
+    if (file.empty())
+        return true;
+
+    metrics_file = file;
+    metrics_interval = std::chrono::milliseconds(static_cast<int64_t>(interval * 1000.0));
+
+    /* Check that the file can be written before starting */
+    if (!write_metrics(format_metrics()))
+        return false;
+
+    metrics_thread = std::thread(run_metrics_thread);
+    enabled_ = true;
+
+    return true;
+}
+
+void
+MetricsExporter::begin_benchmark(const std::string &scene, const std::string &name)
+{
+    std::lock_guard<std::mutex> lock(metrics_mutex);
+
+    current = &metrics[name];
+    current->scene = scene;
+}
+
+void
+MetricsExporter::add_frame(double frame_time)
+{
+    if (!current)
+        return;
+
+    size_t bucket = 0;
+    while (bucket < bucket_count && frame_time > bucket_bounds[bucket])
+        bucket++;
+
+    /* Only this thread modifies the counts, so there is no need for atomic RMW */
+    auto &count = current->buckets[bucket];
+    count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    current->frame_time_sum.store(
+        current->frame_time_sum.load(std::memory_order_relaxed) + frame_time,
+        std::memory_order_relaxed);
+}
+
+void
+MetricsExporter::end_benchmark(const Scene::Stats &stats)
+{
+    std::lock_guard<std::mutex> lock(metrics_mutex);
+
+    if (!current)
+        return;
+
+    current->iterations++;
+    current->have_stats = true;
+    current->fps = stats.average_frame_time > 0.0 ? 1.0 / stats.average_frame_time : 0.0;
+    current->frame_time_p50 = stats.median_frame_time;
+    current->frame_time_p90 = stats.p90_frame_time;
+    current->frame_time_p99 = stats.p99_frame_time;
+    current->cpu_busy = stats.cpu_busy_percent;
+    current = nullptr;
+}
+
+void
+MetricsExporter::end_benchmark_failed()
+{
+    std::lock_guard<std::mutex> lock(metrics_mutex);
+
+    if (!current)
+        return;
+
+    current->failures++;
+    current = nullptr;
+}
+
+void
+MetricsExporter::finish()
+{
+    if (!enabled_)
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(metrics_mutex);
+        metrics_stop = true;
+    }
+    metrics_cv.notify_one();
+    metrics_thread.join();
+
+    std::lock_guard<std::mutex> lock(metrics_mutex);
+    write_metrics(format_metrics());
+    enabled_ = false;
+}
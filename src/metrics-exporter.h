@@ -0,0 +1,89 @@
+/*
+ * Copyright © 2026 Collabora Limited
+ *
+ * This file is part of the glmark2 OpenGL (ES) 2.0 benchmark.
+ *
+ * glmark2 is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * glmark2 is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * glmark2.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef GLMARK2_METRICS_EXPORTER_H_
+#define GLMARK2_METRICS_EXPORTER_H_
+
+#include "scene.h"
+
+#include <string>
+
+/**
+ * Exports per-benchmark metrics in the Prometheus text format, for the
+ * textfile collector of the node exporter.
+ *
+ * The metrics file is rewritten atomically (written to a temporary file,
+ * which is then renamed) every few seconds by a background thread. All
+ * metrics are aggregated incrementally, so memory use doesn't grow over
+ * long runs (e.g. with --run-forever).
+ */
+class MetricsExporter
+{
+public:
+    /**
+     * Starts exporting metrics.
+     *
+     * @param file the metrics file, or an empty string to disable exporting
+     * @param interval the time between updates of the file in seconds
+     *
+     * @return whether the operation succeeded
+     */
+    static bool init(const std::string &file, double interval);
+
+    /**
+     * Whether exporting is enabled.
+     */
+    static bool enabled() { return enabled_; }
+
+    /**
+     * Starts collecting metrics for a benchmark.
+     *
+     * @param scene the scene name
+     * @param name the benchmark name, as returned by Scene::info_string()
+     */
+    static void begin_benchmark(const std::string &scene, const std::string &name);
+
+    /**
+     * Adds a frame to the current benchmark.
+     *
+     * Doesn't take any locks, so it's safe to call for every frame.
+     *
+     * @param frame_time the duration of the frame in seconds
+     */
+    static void add_frame(double frame_time);
+
+    /**
+     * Completes a successful run of the current benchmark.
+     */
+    static void end_benchmark(const Scene::Stats &stats);
+
+    /**
+     * Completes a failed or unsupported run of the current benchmark.
+     */
+    static void end_benchmark_failed();
+
+    /**
+     * Writes the metrics file a last time and stops exporting.
+     */
+    static void finish();
+
+private:
+    static bool enabled_;
+};
+
+#endif /* GLMARK2_METRICS_EXPORTER_H_ */
@@ -27,11 +27,16 @@
 #include "log.h"
 #include "options.h"
 #include "util.h"
+#include "trace.h"
+#include "asset-prefetcher.h"
+#include "mesh-cache.h"
 #include "float.h"
 #include "math.h"
 #include <algorithm>
 #include <fstream>
+#include <future>
 #include <sstream>
+#include <unordered_map>
 #include <memory>
 
 using std::string;
@@ -123,8 +128,12 @@ Model::compute_bounding_box(const Object& object)
 void
 Model::append_object_to_mesh(const Object &object, Mesh &mesh,
                              int p_pos, int n_pos, int t_pos,
-                             int nt_pos, int nb_pos)
+                             int nt_pos, int nb_pos, bool indexed)
 {
+    // The mesh vertex of each distinct combination of position, texcoord
+    // and normal indices, for welding the face corners of indexed meshes.
+    std::unordered_map<uint64_t, unsigned int> welded;
+
     for (vector<Face>::const_iterator faceIt = object.faces.begin();
          faceIt != object.faces.end();
          faceIt++)
@@ -133,57 +142,43 @@ Model::append_object_to_mesh(const Object &object, Mesh &mesh,
         // may contain separate indices per-attribute.  So, we need to allow
         // for this when adding each vertex attribute to the mesh.
         const Face &face = *faceIt;
-        const Vertex &v1 = object.vertices[face.v.x()];
-        const Vertex &v2 = object.vertices[face.v.y()];
-        const Vertex &v3 = object.vertices[face.v.z()];
-
         bool separate_t(face.which & Face::OBJ_FACE_T);
-
-        const Vertex &t1 = object.vertices[separate_t ? face.t.x() : face.v.x()];
-        const Vertex &t2 = object.vertices[separate_t ? face.t.y() : face.v.y()];
-        const Vertex &t3 = object.vertices[separate_t ? face.t.z() : face.v.z()];
-
         bool separate_n(face.which & Face::OBJ_FACE_N);
-
-        const Vertex &n1 = object.vertices[separate_n ? face.n.x() : face.v.x()];
-        const Vertex &n2 = object.vertices[separate_n ? face.n.y() : face.v.y()];
-        const Vertex &n3 = object.vertices[separate_n ? face.n.z() : face.v.z()];
-
-        mesh.next_vertex();
-        if (p_pos >= 0)
-            mesh.set_attrib(p_pos, v1.v);
-        if (n_pos >= 0)
-            mesh.set_attrib(n_pos, n1.n);
-        if (t_pos >= 0)
-            mesh.set_attrib(t_pos, t1.t);
-        if (nt_pos >= 0)
-            mesh.set_attrib(nt_pos, v1.nt);
-        if (nb_pos >= 0)
-            mesh.set_attrib(nb_pos, v1.nb);
-
-        mesh.next_vertex();
-        if (p_pos >= 0)
-            mesh.set_attrib(p_pos, v2.v);
-        if (n_pos >= 0)
-            mesh.set_attrib(n_pos, n2.n);
-        if (t_pos >= 0)
-            mesh.set_attrib(t_pos, t2.t);
-        if (nt_pos >= 0)
-            mesh.set_attrib(nt_pos, v2.nt);
-        if (nb_pos >= 0)
-            mesh.set_attrib(nb_pos, v2.nb);
-
-        mesh.next_vertex();
-        if (p_pos >= 0)
-            mesh.set_attrib(p_pos, v3.v);
-        if (n_pos >= 0)
-            mesh.set_attrib(n_pos, n3.n);
-        if (t_pos >= 0)
-            mesh.set_attrib(t_pos, t3.t);
-        if (nt_pos >= 0)
-            mesh.set_attrib(nt_pos, v3.nt);
-        if (nb_pos >= 0)
-            mesh.set_attrib(nb_pos, v3.nb);
+        const unsigned int v_index[3] = {face.v.x(), face.v.y(), face.v.z()};
+        const unsigned int t_index[3] = {face.t.x(), face.t.y(), face.t.z()};
+        const unsigned int n_index[3] = {face.n.x(), face.n.y(), face.n.z()};
+
+        for (int i = 0; i < 3; i++) {
+            unsigned int vi = v_index[i];
+            unsigned int ti = separate_t ? t_index[i] : vi;
+            unsigned int ni = separate_n ? n_index[i] : vi;
+
+            if (indexed) {
+                uint64_t key = (static_cast<uint64_t>(vi) * object.vertices.size() + ti) *
+                               object.vertices.size() + ni;
+                auto found = welded.find(key);
+                if (found != welded.end()) {
+                    mesh.add_index(found->second);
+                    continue;
+                }
+                welded[key] = mesh.num_vertices();
+                mesh.add_index(mesh.num_vertices());
+            }
+
+            const Vertex &v = object.vertices[vi];
+
+            mesh.next_vertex();
+            if (p_pos >= 0)
+                mesh.set_attrib(p_pos, v.v);
+            if (n_pos >= 0)
+                mesh.set_attrib(n_pos, object.vertices[ni].n);
+            if (t_pos >= 0)
+                mesh.set_attrib(t_pos, object.vertices[ti].t);
+            if (nt_pos >= 0)
+                mesh.set_attrib(nt_pos, v.nt);
+            if (nb_pos >= 0)
+                mesh.set_attrib(nb_pos, v.nb);
+        }
     }
 }
 
@@ -193,9 +188,10 @@ Model::append_object_to_mesh(const Object &object, Mesh &mesh,
  * The default attributes and their order is: Position, Normal, Texcoord
  *
  * @param mesh the mesh to populate
+ * @param indexed whether to build an indexed mesh, sharing identical vertices
  */
 void
-Model::convert_to_mesh(Mesh &mesh)
+Model::convert_to_mesh(Mesh &mesh, bool indexed)
 {
     std::vector<std::pair<AttribType, int> > attribs;
 
@@ -203,7 +199,7 @@ Model::convert_to_mesh(Mesh &mesh)
     attribs.push_back(std::pair<AttribType, int>(AttribTypeNormal, 3));
     attribs.push_back(std::pair<AttribType, int>(AttribTypeTexcoord, 2));
 
-    convert_to_mesh(mesh, attribs);
+    convert_to_mesh(mesh, attribs, indexed);
 }
 
 /**
@@ -211,14 +207,23 @@ Model::convert_to_mesh(Mesh &mesh)
  *
  * The attribute bindings are pairs of <AttribType, dimensionality>.
  *
+ * The vertex format sets how the mesh stores the attributes for drawing:
+ * "float" stores them as floats, "half" as half floats, and "packed" stores
+ * positions as half floats, normals, tangents and bitangents as 2_10_10_10
+ * normalized integers, and texcoords as normalized shorts.
+ *
  * @param mesh the mesh to populate
  * @param attribs the attribute bindings to use
+ * @param indexed whether to build an indexed mesh, sharing identical vertices
+ * @param vertex_format the attribute storage formats to use
  */
 void
 Model::convert_to_mesh(Mesh &mesh,
-                       const std::vector<std::pair<AttribType, int> > &attribs)
+                       const std::vector<std::pair<AttribType, int> > &attribs,
+                       bool indexed, const std::string &vertex_format)
 {
     std::vector<int> format;
+    std::vector<Mesh::AttribFormat> storage;
     int p_pos = -1;
     int n_pos = -1;
     int t_pos = -1;
@@ -232,6 +237,23 @@ Model::convert_to_mesh(Mesh &mesh,
          ai++)
     {
         format.push_back(ai->second);
+
+        if (vertex_format == "half") {
+            storage.push_back(Mesh::AttribFormatHalfFloat);
+        }
+        else if (vertex_format == "packed") {
+            if (ai->first == AttribTypeTexcoord)
+                storage.push_back(Mesh::AttribFormatUnsignedShortNormalized);
+            else if (ai->first == AttribTypeNormal || ai->first == AttribTypeTangent ||
+                     ai->first == AttribTypeBitangent)
+                storage.push_back(Mesh::AttribFormatInt2101010Rev);
+            else
+                storage.push_back(Mesh::AttribFormatHalfFloat);
+        }
+        else {
+            storage.push_back(Mesh::AttribFormatFloat);
+        }
+
         if (ai->first == AttribTypePosition)
             p_pos = ai - attribs.begin();
         else if (ai->first == AttribTypeNormal)
@@ -244,13 +266,25 @@ Model::convert_to_mesh(Mesh &mesh,
             nb_pos = ai - attribs.begin();
     }
 
-    mesh.set_vertex_format(format);
+    mesh.set_vertex_format(format, storage);
 
+    // Allocate the mesh storage once, for three vertices per face, or
+    // about one per model vertex when welding them
+    size_t nvertices = 0;
     for (std::vector<Object>::const_iterator iter = objects_.begin();
          iter != objects_.end();
          iter++)
     {
-        append_object_to_mesh(*iter, mesh, p_pos, n_pos, t_pos, nt_pos, nb_pos);
+        nvertices += indexed ? iter->vertices.size() : 3 * iter->faces.size();
+    }
+    mesh.reserve_vertices(nvertices);
+
+    for (std::vector<Object>::const_iterator iter = objects_.begin();
+         iter != objects_.end();
+         iter++)
+    {
+        append_object_to_mesh(*iter, mesh, p_pos, n_pos, t_pos, nt_pos, nb_pos,
+                              indexed);
     }
 }
 
@@ -811,6 +845,10 @@ Model::load_obj(const std::filesystem::path &filename)
 namespace ModelPrivate
 {
 ModelMap modelMap;
+/* Parsed models, kept with --reuse-context until the scene using them changes */
+std::map<string, Model> modelCache;
+/* Models being parsed by the asset prefetcher, for the next scene */
+std::map<string, std::future<std::unique_ptr<Model>>> prefetched;
 }
 
 /**
@@ -871,6 +909,7 @@ Model::find_models()
 bool
 Model::load(const string& modelName)
 {
+    TraceSpan span("load_model", "asset", modelName);
     bool retVal(false);
     ModelMap::const_iterator modelIt = ModelPrivate::modelMap.find(modelName);
     if (modelIt == ModelPrivate::modelMap.end())
@@ -878,18 +917,306 @@ Model::load(const string& modelName)
         return retVal;
     }
 
-    ModelDescriptor* desc = modelIt->second.get();
-    switch (desc->format())
+    std::map<string, Model>::const_iterator cacheIt = ModelPrivate::modelCache.find(modelName);
+    if (cacheIt != ModelPrivate::modelCache.end())
+    {
+        *this = cacheIt->second;
+        return true;
+    }
+
+    auto prefetchIt = ModelPrivate::prefetched.find(modelName);
+    if (prefetchIt != ModelPrivate::prefetched.end())
+    {
+        // Wait for the prefetcher if it is still parsing the model
+        std::unique_ptr<Model> prefetched(prefetchIt->second.get());
+        ModelPrivate::prefetched.erase(prefetchIt);
+        if (prefetched)
+        {
+            *this = std::move(*prefetched);
+            if (Options::reuse_context)
+                ModelPrivate::modelCache[modelName] = *this;
+            return true;
+        }
+    }
+
+    retVal = load_file(*modelIt->second);
+
+    // Only a reused context can set up the scene again with the same model
+    if (retVal && Options::reuse_context)
+        ModelPrivate::modelCache[modelName] = *this;
+
+    return retVal;
+}
+
+/**
+ * Load a model from its file.
+ *
+ * @param desc the descriptor of the model
+ *
+ * @return whether the operation succeeded
+ */
+bool
+Model::load_file(const ModelDescriptor& desc)
+{
+    if (MeshCache::enabled() && load_cached(desc.pathname()))
+        return true;
+
+    bool retVal(false);
+
+    switch (desc.format())
     {
         case MODEL_INVALID:
             break;
         case MODEL_3DS:
-            retVal = load_3ds(desc->pathname());
+            retVal = load_3ds(desc.pathname());
             break;
         case MODEL_OBJ:
-            retVal = load_obj(desc->pathname());
+            retVal = load_obj(desc.pathname());
             break;
     }
 
+    if (retVal && MeshCache::enabled())
+        store_cached(desc.pathname());
+
     return retVal;
 }
+
+namespace
+{
+
+/* The first stream of a cached model */
+struct CachedModelInfo {
+    uint32_t gotTexcoords;
+    uint32_t gotNormals;
+    uint32_t nobjects;
+    float minVec[3];
+    float maxVec[3];
+};
+
+/* The face data of a cached model, as in Model::Face */
+struct CachedFace {
+    uint32_t v[3];
+    uint32_t n[3];
+    uint32_t t[3];
+    uint32_t which;
+};
+
+/* The number of streams for each object: name, positions, normals, texcoords and faces */
+const size_t cachedObjectStreams = 5;
+
+}
+
+/**
+ * Load a model from the mesh cache.
+ *
+ * @param filename the name of the model file
+ *
+ * @return whether the model was cached
+ */
+bool
+Model::load_cached(const std::filesystem::path &filename)
+{
+    std::unique_ptr<MeshCache::Entry> entry(MeshCache::load(filename));
+    if (!entry)
+        return false;
+
+    size_t count = 0;
+    const CachedModelInfo *info = entry->stream<CachedModelInfo>(0, count);
+    if (!info || count != 1 || entry->size() != 1 + info->nobjects * cachedObjectStreams)
+        return false;
+
+    std::vector<Object> objects;
+
+    for (size_t i = 0; i < info->nobjects; i++)
+    {
+        size_t first = 1 + i * cachedObjectStreams;
+        size_t nameSize = 0, npositions = 0, nnormals = 0, ntexcoords = 0, nfaces = 0;
+        const char *name = entry->stream<char>(first, nameSize);
+        const float *positions = entry->stream<float>(first + 1, npositions);
+        const float *normals = entry->stream<float>(first + 2, nnormals);
+        const float *texcoords = entry->stream<float>(first + 3, ntexcoords);
+        const CachedFace *faces = entry->stream<CachedFace>(first + 4, nfaces);
+        size_t nvertices = npositions / 3;
+
+        if (!name || !positions || !normals || !texcoords || !faces ||
+            npositions != 3 * nvertices || nnormals != 3 * nvertices ||
+            ntexcoords != 2 * nvertices)
+        {
+            return false;
+        }
+
+        objects.push_back(Object(string(name, nameSize)));
+        Object &object = objects.back();
+
+        object.vertices.resize(nvertices);
+        for (size_t v = 0; v < nvertices; v++)
+        {
+            Vertex &vertex = object.vertices[v];
+            vertex.v = vec3(positions[3 * v], positions[3 * v + 1], positions[3 * v + 2]);
+            vertex.n = vec3(normals[3 * v], normals[3 * v + 1], normals[3 * v + 2]);
+            vertex.t = vec2(texcoords[2 * v], texcoords[2 * v + 1]);
+        }
+
+        object.faces.resize(nfaces);
+        for (size_t f = 0; f < nfaces; f++)
+        {
+            const CachedFace &cached = faces[f];
+            Face &face = object.faces[f];
+
+            for (int c = 0; c < 3; c++)
+            {
+                if (cached.v[c] >= nvertices ||
+                    ((cached.which & Face::OBJ_FACE_N) && cached.n[c] >= nvertices) ||
+                    ((cached.which & Face::OBJ_FACE_T) && cached.t[c] >= nvertices))
+                {
+                    return false;
+                }
+            }
+
+            face.v = uvec3(cached.v[0], cached.v[1], cached.v[2]);
+            face.n = uvec3(cached.n[0], cached.n[1], cached.n[2]);
+            face.t = uvec3(cached.t[0], cached.t[1], cached.t[2]);
+            face.which = cached.which;
+        }
+    }
+
+    objects_.swap(objects);
+    gotTexcoords_ = info->gotTexcoords;
+    gotNormals_ = info->gotNormals;
+    minVec_ = vec3(info->minVec[0], info->minVec[1], info->minVec[2]);
+    maxVec_ = vec3(info->maxVec[0], info->maxVec[1], info->maxVec[2]);
+
+    return true;
+}
+
+/**
+ * Store a model, as parsed from its file, in the mesh cache.
+ *
+ * @param filename the name of the model file
+ */
+void
+Model::store_cached(const std::filesystem::path &filename) const
+{
+    CachedModelInfo info;
+    info.gotTexcoords = gotTexcoords_;
+    info.gotNormals = gotNormals_;
+    info.nobjects = objects_.size();
+    info.minVec[0] = minVec_.x();
+    info.minVec[1] = minVec_.y();
+    info.minVec[2] = minVec_.z();
+    info.maxVec[0] = maxVec_.x();
+    info.maxVec[1] = maxVec_.y();
+    info.maxVec[2] = maxVec_.z();
+
+    std::vector<std::vector<float>> attribs;
+    std::vector<std::vector<CachedFace>> faces;
+    std::vector<MeshCache::Stream> streams;
+
+    streams.push_back(MeshCache::Stream(&info, sizeof(info)));
+
+    for (std::vector<Object>::const_iterator iter = objects_.begin();
+         iter != objects_.end();
+         iter++)
+    {
+        const Object &object = *iter;
+        std::vector<float> positions;
+        std::vector<float> normals;
+        std::vector<float> texcoords;
+
+        for (vector<Vertex>::const_iterator vIt = object.vertices.begin();
+             vIt != object.vertices.end();
+             vIt++)
+        {
+            positions.insert(positions.end(), {vIt->v.x(), vIt->v.y(), vIt->v.z()});
+            normals.insert(normals.end(), {vIt->n.x(), vIt->n.y(), vIt->n.z()});
+            texcoords.insert(texcoords.end(), {vIt->t.x(), vIt->t.y()});
+        }
+
+        faces.push_back(std::vector<CachedFace>());
+        for (vector<Face>::const_iterator fIt = object.faces.begin();
+             fIt != object.faces.end();
+             fIt++)
+        {
+            faces.back().push_back({{fIt->v.x(), fIt->v.y(), fIt->v.z()},
+                                    {fIt->n.x(), fIt->n.y(), fIt->n.z()},
+                                    {fIt->t.x(), fIt->t.y(), fIt->t.z()},
+                                    fIt->which});
+        }
+
+        attribs.push_back(std::move(positions));
+        attribs.push_back(std::move(normals));
+        attribs.push_back(std::move(texcoords));
+    }
+
+    for (size_t i = 0; i < objects_.size(); i++)
+    {
+        streams.push_back(MeshCache::Stream(objects_[i].name.data(), objects_[i].name.size()));
+        for (size_t a = 0; a < 3; a++)
+        {
+            const std::vector<float> &attrib = attribs[3 * i + a];
+            streams.push_back(MeshCache::Stream(attrib.data(), attrib.size() * sizeof(float)));
+        }
+        streams.push_back(MeshCache::Stream(faces[i].data(), faces[i].size() * sizeof(CachedFace)));
+    }
+
+    MeshCache::store(filename, streams);
+}
+
+/**
+ * Start parsing models on the asset prefetcher thread.
+ *
+ * Model::load() picks up the parsed models. Models that were prefetched
+ * before, but not loaded since, are dropped.
+ *
+ * @param modelNames the names of the models to parse
+ */
+void
+Model::prefetch(const vector<string>& modelNames)
+{
+    const ModelMap& modelMap = find_models();
+
+    for (auto it = ModelPrivate::prefetched.begin(); it != ModelPrivate::prefetched.end();)
+    {
+        if (std::find(modelNames.begin(), modelNames.end(), it->first) == modelNames.end())
+            it = ModelPrivate::prefetched.erase(it);
+        else
+            ++it;
+    }
+
+    for (const auto& modelName : modelNames)
+    {
+        ModelMap::const_iterator modelIt = modelMap.find(modelName);
+        if (modelIt == modelMap.end() ||
+            ModelPrivate::modelCache.count(modelName) ||
+            ModelPrivate::prefetched.count(modelName))
+        {
+            continue;
+        }
+
+        const ModelDescriptor* desc = modelIt->second.get();
+        auto task = std::make_shared<std::packaged_task<std::unique_ptr<Model>()>>(
+            [desc, modelName]() {
+                TraceSpan span("prefetch_model", "asset", modelName);
+                std::unique_ptr<Model> model(new Model());
+                if (!model->load_file(*desc))
+                    model.reset();
+                return model;
+            });
+
+        ModelPrivate::prefetched[modelName] = task->get_future();
+        AssetPrefetcher::add_task([task]() { (*task)(); });
+    }
+}
+
+/**
+ * Release the models cached by Model::load().
+ *
+ * With --reuse-context, loading a model that was loaded before since the last
+ * call of this method copies the parsed data instead of reading the model file
+ * again.
+ */
+void
+Model::clear_cache()
+{
+    ModelPrivate::modelCache.clear();
+}
@@ -89,12 +89,16 @@ public:
     bool needNormals() const { return !gotNormals_; }
     void calculate_texcoords();
     void calculate_normals();
-    void convert_to_mesh(Mesh &mesh);
+    void convert_to_mesh(Mesh &mesh, bool indexed = false);
     void convert_to_mesh(Mesh &mesh,
-                         const std::vector<std::pair<AttribType, int> > &attribs);
+                         const std::vector<std::pair<AttribType, int> > &attribs,
+                         bool indexed = false,
+                         const std::string &vertex_format = "float");
     const LibMatrix::vec3& minVec() const { return minVec_; }
     const LibMatrix::vec3& maxVec() const { return maxVec_; }
     static const ModelMap& find_models();
+    static void clear_cache();
+    static void prefetch(const std::vector<std::string>& names);
 private:
     // If the model we loaded contained texcoord or normal data...
     bool gotTexcoords_;
@@ -127,7 +131,10 @@ private:
 
     void append_object_to_mesh(const Object &object, Mesh &mesh,
                                int p_pos, int n_pos, int t_pos,
-                               int nt_pos, int nb_pos);
+                               int nt_pos, int nb_pos, bool indexed);
+    bool load_file(const ModelDescriptor& desc);
+    bool load_cached(const std::filesystem::path &filename);
+    void store_cached(const std::filesystem::path &filename) const;
     bool load_3ds(const std::filesystem::path &filename);
     bool load_obj(const std::filesystem::path &filename);
     void obj_get_attrib(const std::string& description, LibMatrix::vec2& v);
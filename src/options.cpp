@@ -41,13 +41,33 @@ bool Options::show_debug = false;
 bool Options::show_version = false;
 bool Options::show_help = false;
 bool Options::reuse_context = false;
+bool Options::prefetch_assets = false;
 bool Options::run_forever = false;
+unsigned int Options::repeat = 1;
+Options::RepeatOrder Options::repeat_order = Options::RepeatOrderInterleaved;
 bool Options::annotate = false;
 unsigned int Options::offscreen = 0;
 GLVisualConfig Options::visual_config;
 bool Options::good_config = false;
 Options::Results Options::results = Options::ResultsFps;
 std::string Options::results_file;
+bool Options::results_frames = false;
+std::string Options::results_stream;
+unsigned int Options::results_stream_frames = 0;
+std::string Options::trace_file;
+std::string Options::frame_log;
+std::string Options::frame_log_dump;
+Options::FrameLogFormat Options::frame_log_format = Options::FrameLogFormatCSV;
+std::string Options::metrics_file;
+double Options::metrics_interval = 5.0;
+std::string Options::baseline;
+double Options::max_regression = 0.05;
+bool Options::compare = false;
+std::vector<std::string> Options::compare_files;
+Options::CompareFormat Options::compare_format = Options::CompareFormatText;
+std::string Options::program_cache;
+Options::ProgramCacheMode Options::program_cache_mode = Options::ProgramCacheModeUse;
+std::string Options::mesh_cache;
 std::vector<Options::WindowSystemOption> Options::winsys_options;
 std::string Options::winsys_options_help;
 
@@ -63,11 +83,30 @@ static struct option long_options[] = {
     {"visual-config", 1, 0, 0},
     {"good-config", 0, 0, 0},
     {"reuse-context", 0, 0, 0},
+    {"prefetch-assets", 0, 0, 0},
     {"run-forever", 0, 0, 0},
+    {"repeat", 1, 0, 0},
+    {"repeat-order", 1, 0, 0},
     {"size", 1, 0, 0},
     {"fullscreen", 0, 0, 0},
     {"results", 1, 0, 0},
     {"results-file", 1, 0, 0},
+    {"results-frames", 0, 0, 0},
+    {"results-stream", 1, 0, 0},
+    {"results-stream-frames", 1, 0, 0},
+    {"trace-file", 1, 0, 0},
+    {"frame-log", 1, 0, 0},
+    {"frame-log-dump", 1, 0, 0},
+    {"frame-log-format", 1, 0, 0},
+    {"metrics-file", 1, 0, 0},
+    {"metrics-interval", 1, 0, 0},
+    {"baseline", 1, 0, 0},
+    {"max-regression", 1, 0, 0},
+    {"compare", 0, 0, 0},
+    {"compare-format", 1, 0, 0},
+    {"program-cache", 1, 0, 0},
+    {"program-cache-mode", 1, 0, 0},
+    {"mesh-cache", 1, 0, 0},
     {"winsys-options", 1, 0, 0},
     {"list-scenes", 0, 0, 0},
     {"show-all-options", 0, 0, 0},
@@ -147,6 +186,90 @@ swap_mode_from_str(const std::string &str)
     return m;
 }
 
+/**
+ * Parses a repeat order string
+ *
+ * @param str the string to parse
+ *
+ * @return the parsed repeat order
+ */
+static Options::RepeatOrder
+repeat_order_from_str(const std::string &str)
+{
+    Options::RepeatOrder o = Options::RepeatOrderInterleaved;
+
+    if (str == "sequential")
+        o = Options::RepeatOrderSequential;
+    else if (str == "shuffled")
+        o = Options::RepeatOrderShuffled;
+    else if (str != "interleaved")
+        throw std::runtime_error{"Invalid repeat order '" + str + "'"};
+
+    return o;
+}
+
+/**
+ * Parses a frame log output format string
+ *
+ * @param str the string to parse
+ *
+ * @return the parsed frame log format
+ */
+static Options::FrameLogFormat
+frame_log_format_from_str(const std::string &str)
+{
+    Options::FrameLogFormat f = Options::FrameLogFormatCSV;
+
+    if (str == "json")
+        f = Options::FrameLogFormatJSON;
+    else if (str != "csv")
+        throw std::runtime_error{"Invalid frame log format '" + str + "'"};
+
+    return f;
+}
+
+/**
+ * Parses a comparison output format string
+ *
+ * @param str the string to parse
+ *
+ * @return the parsed comparison format
+ */
+static Options::CompareFormat
+compare_format_from_str(const std::string &str)
+{
+    Options::CompareFormat f = Options::CompareFormatText;
+
+    if (str == "json")
+        f = Options::CompareFormatJSON;
+    else if (str != "text")
+        throw std::runtime_error{"Invalid compare format '" + str + "'"};
+
+    return f;
+}
+
+/**
+ * Parses a program cache mode string
+ *
+ * @param str the string to parse
+ *
+ * @return the parsed program cache mode
+ */
+static Options::ProgramCacheMode
+program_cache_mode_from_str(const std::string &str)
+{
+    Options::ProgramCacheMode m = Options::ProgramCacheModeUse;
+
+    if (str == "bypass")
+        m = Options::ProgramCacheModeBypass;
+    else if (str == "refresh")
+        m = Options::ProgramCacheModeRefresh;
+    else if (str != "use")
+        throw std::runtime_error{"Invalid program cache mode '" + str + "'"};
+
+    return m;
+}
+
 Options::Results
 results_from_str(std::string const& str)
 {
@@ -163,6 +286,16 @@ results_from_str(std::string const& str)
             results = static_cast<Options::Results>(results | Options::ResultsCpu);
         else if (res == "shader")
             results = static_cast<Options::Results>(results | Options::ResultsShader);
+        else if (res == "frametime")
+            results = static_cast<Options::Results>(results | Options::ResultsFrameTime);
+        else if (res == "gpu")
+            results = static_cast<Options::Results>(results | Options::ResultsGpu);
+        else if (res == "phases")
+            results = static_cast<Options::Results>(results | Options::ResultsPhases);
+        else if (res == "perf")
+            results = static_cast<Options::Results>(results | Options::ResultsPerf);
+        else if (res == "memory")
+            results = static_cast<Options::Results>(results | Options::ResultsMemory);
         else
             throw std::runtime_error{"Invalid result type '" + res + "'"};
     }
@@ -212,6 +345,84 @@ offscreen_from_str(std::string const& str)
     return ret;
 }
 
+unsigned int
+repeat_from_str(std::string const& str)
+{
+    int ret = 0;
+    try
+    {
+        ret = std::stol(str);
+        if (ret < 1) throw std::runtime_error{""};
+    }
+    catch (...)
+    {
+        throw std::runtime_error{"Invalid repeat option value '" + str + "'"};
+    }
+
+    return ret;
+}
+
+static unsigned int
+results_stream_frames_from_str(std::string const& str)
+{
+    int ret = 0;
+    try
+    {
+        ret = std::stol(str);
+        if (ret < 0) throw std::runtime_error{""};
+    }
+    catch (...)
+    {
+        throw std::runtime_error{"Invalid results-stream-frames option value '" + str + "'"};
+    }
+
+    return ret;
+}
+
+static double
+metrics_interval_from_str(std::string const& str)
+{
+    double ret = 0.0;
+    try
+    {
+        ret = std::stod(str);
+        if (ret <= 0.0) throw std::runtime_error{""};
+    }
+    catch (...)
+    {
+        throw std::runtime_error{"Invalid metrics-interval option value '" + str + "'"};
+    }
+
+    return ret;
+}
+
+/**
+ * Parses a maximum regression string, either as a percentage ("5%") or
+ * as a plain number of percent ("5")
+ *
+ * @param str the string to parse
+ *
+ * @return the parsed maximum regression as a fraction
+ */
+static double
+max_regression_from_str(std::string const& str)
+{
+    double ret = 0.0;
+    try
+    {
+        size_t pos = 0;
+        ret = std::stod(str, &pos);
+        if (pos < str.size() && str.substr(pos) != "%") throw std::runtime_error{""};
+        if (ret < 0.0) throw std::runtime_error{""};
+    }
+    catch (...)
+    {
+        throw std::runtime_error{"Invalid max-regression option value '" + str + "'"};
+    }
+
+    return ret / 100.0;
+}
+
 void
 Options::print_help()
 {
@@ -219,7 +430,10 @@ Options::print_help()
            "\n"
            "Options:\n"
            "  -b, --benchmark BENCH  A benchmark or options to run: '(scene)?(:opt1=val1)*'\n"
-           "                         (the option can be used multiple times)\n"
+           "                         (the option can be used multiple times). Option\n"
+           "                         values can be sweeps, '{v1,v2,...}', 'a..b/step' or\n"
+           "                         'a..b*factor', to run a benchmark for each value\n"
+           "                         and report scaling curves\n"
            "  -f, --benchmark-file F Load benchmarks to run from a file containing a\n"
            "                         list of benchmark descriptions (one per line)\n"
            "                         (the option can be used multiple times)\n"
@@ -243,13 +457,52 @@ Options::print_help()
            "      --good-config      Require a config that meets all the requested component\n"
            "                         requirements (see --visual-config)\n"
            "      --reuse-context    Use a single context for all scenes\n"
-           "                         (by default, each scene gets its own context)\n"
+           "                         (by default, each scene gets its own context).\n"
+           "                         Consecutive benchmarks of the same scene also\n"
+           "                         share their loaded models and images\n"
+           "      --prefetch-assets  Load the models and images of the next benchmark\n"
+           "                         on a background thread while the current one runs\n"
            "  -s, --size WxH         Size of the output window (default: 800x600)\n"
            "      --fullscreen       Run in fullscreen mode (equivalent to --size -1x-1)\n"
            "      --results RESULTS  The types of results to report for each benchmark,\n"
-           "                         as a ':' separated list [fps,cpu,shader]\n"
+           "                         as a ':' separated list [fps,cpu,shader,frametime,\n"
+           "                         gpu,phases,perf,memory]\n"
            "      --results-file F   The file to save the results to, in the format determined\n"
-           "                         by the file extension [csv,xml]\n"
+           "                         by the file extension [csv,xml,json]\n"
+           "      --results-frames   Also save the time of every frame to the results file\n"
+           "                         (only supported by the json format)\n"
+           "      --results-stream T Stream the results live as JSON lines to T: a named\n"
+           "                         pipe or file, 'unix:PATH' or 'fd:N'\n"
+           "      --results-stream-frames N\n"
+           "                         Also stream frame time statistics every N frames\n"
+           "      --trace-file F     Save a trace of the benchmark run (scenes, frames,\n"
+           "                         frame phases, shader compilation and asset loading)\n"
+           "                         to a file in the Chrome trace event JSON format\n"
+           "      --frame-log F      Log the time of every frame to a compact binary file\n"
+           "      --frame-log-dump F Convert a binary frame log to text, without running\n"
+           "                         any benchmarks\n"
+           "      --frame-log-format F\n"
+           "                         The output format of --frame-log-dump [csv,json]\n"
+           "      --metrics-file F   Export metrics for each benchmark to a file in the\n"
+           "                         Prometheus text format (for the node exporter)\n"
+           "      --metrics-interval S\n"
+           "                         The time between metrics file updates in seconds\n"
+           "                         (default: 5)\n"
+           "      --baseline F       Compare the results against a previous json results\n"
+           "                         file and report regressions\n"
+           "      --max-regression P The largest allowed increase of the frame time\n"
+           "                         compared to the baseline (default: 5%%)\n"
+           "      --compare A B...   Compare json results files against the first one,\n"
+           "                         without running any benchmarks\n"
+           "      --compare-format F The output format of --compare [text,json]\n"
+           "      --program-cache D  Cache linked program binaries in directory D, to\n"
+           "                         avoid compiling the same shaders in later runs\n"
+           "      --program-cache-mode M\n"
+           "                         How to use the program cache: 'use' cached programs,\n"
+           "                         'bypass' the cache to measure compilation times, or\n"
+           "                         'refresh' the cached programs (default: use)\n"
+           "      --mesh-cache D     Cache parsed models in directory D, to avoid parsing\n"
+           "                         the model files in later runs\n"
            "      --winsys-options O A list of 'opt=value' pairs for window system specific\n"
            "                         options, separated by ':'\n"
            "  -l, --list-scenes      Display information about the available scenes\n"
@@ -258,6 +511,10 @@ Options::print_help()
            "                         (only explicitly set options are shown by default)\n"
            "      --run-forever      Run indefinitely, looping from the last benchmark\n"
            "                         back to the first\n"
+           "      --repeat N         Run the benchmark list N times and report statistics\n"
+           "                         across the runs of each benchmark (default: 1)\n"
+           "      --repeat-order O   The order of the repeated runs\n"
+           "                         [interleaved,sequential,shuffled]\n"
            "      --annotate         Annotate the benchmarks with on-screen information\n"
            "                         (same as -b :show-fps=true:title=#info#)\n"
            "  -d, --debug            Display debug messages\n"
@@ -311,6 +568,8 @@ Options::parse_args(int argc, char **argv)
             Options::good_config = true;
         else if (!strcmp(optname, "reuse-context"))
             Options::reuse_context = true;
+        else if (!strcmp(optname, "prefetch-assets"))
+            Options::prefetch_assets = true;
         else if (c == 's' || !strcmp(optname, "size"))
             parse_size(optarg, Options::size);
         else if (!strcmp(optname, "fullscreen"))
@@ -319,6 +578,38 @@ Options::parse_args(int argc, char **argv)
             Options::results = results_from_str(optarg);
         else if (!strcmp(optname, "results-file"))
             Options::results_file = optarg;
+        else if (!strcmp(optname, "results-frames"))
+            Options::results_frames = true;
+        else if (!strcmp(optname, "results-stream"))
+            Options::results_stream = optarg;
+        else if (!strcmp(optname, "results-stream-frames"))
+            Options::results_stream_frames = results_stream_frames_from_str(optarg);
+        else if (!strcmp(optname, "trace-file"))
+            Options::trace_file = optarg;
+        else if (!strcmp(optname, "frame-log"))
+            Options::frame_log = optarg;
+        else if (!strcmp(optname, "frame-log-dump"))
+            Options::frame_log_dump = optarg;
+        else if (!strcmp(optname, "frame-log-format"))
+            Options::frame_log_format = frame_log_format_from_str(optarg);
+        else if (!strcmp(optname, "metrics-file"))
+            Options::metrics_file = optarg;
+        else if (!strcmp(optname, "metrics-interval"))
+            Options::metrics_interval = metrics_interval_from_str(optarg);
+        else if (!strcmp(optname, "baseline"))
+            Options::baseline = optarg;
+        else if (!strcmp(optname, "max-regression"))
+            Options::max_regression = max_regression_from_str(optarg);
+        else if (!strcmp(optname, "compare"))
+            Options::compare = true;
+        else if (!strcmp(optname, "compare-format"))
+            Options::compare_format = compare_format_from_str(optarg);
+        else if (!strcmp(optname, "program-cache"))
+            Options::program_cache = optarg;
+        else if (!strcmp(optname, "program-cache-mode"))
+            Options::program_cache_mode = program_cache_mode_from_str(optarg);
+        else if (!strcmp(optname, "mesh-cache"))
+            Options::mesh_cache = optarg;
         else if (!strcmp(optname, "winsys-options"))
             Options::winsys_options = winsys_options_from_str(optarg);
         else if (c == 'l' || !strcmp(optname, "list-scenes"))
@@ -327,6 +618,10 @@ Options::parse_args(int argc, char **argv)
             Options::show_all_options = true;
         else if (!strcmp(optname, "run-forever"))
             Options::run_forever = true;
+        else if (!strcmp(optname, "repeat"))
+            Options::repeat = repeat_from_str(optarg);
+        else if (!strcmp(optname, "repeat-order"))
+            Options::repeat_order = repeat_order_from_str(optarg);
         else if (c == 'd' || !strcmp(optname, "debug"))
             Options::show_debug = true;
         else if (!strcmp(optname, "version"))
@@ -335,5 +630,11 @@ Options::parse_args(int argc, char **argv)
             Options::show_help = true;
     }
 
+    /* The remaining arguments are the files to compare */
+    if (Options::compare) {
+        for (int i = optind; i < argc; i++)
+            Options::compare_files.push_back(argv[i]);
+    }
+
     return true;
 }
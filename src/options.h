@@ -54,6 +54,33 @@ struct Options {
         ResultsFps = 1,
         ResultsCpu = 2,
         ResultsShader = 4,
+        ResultsFrameTime = 8,
+        ResultsGpu = 16,
+        ResultsPhases = 32,
+        ResultsPerf = 64,
+        ResultsMemory = 128,
+    };
+
+    enum RepeatOrder {
+        RepeatOrderInterleaved,
+        RepeatOrderSequential,
+        RepeatOrderShuffled,
+    };
+
+    enum FrameLogFormat {
+        FrameLogFormatCSV,
+        FrameLogFormatJSON,
+    };
+
+    enum CompareFormat {
+        CompareFormatText,
+        CompareFormatJSON,
+    };
+
+    enum ProgramCacheMode {
+        ProgramCacheModeUse,
+        ProgramCacheModeBypass,
+        ProgramCacheModeRefresh,
     };
 
     static bool parse_args(int argc, char **argv);
@@ -72,13 +99,33 @@ struct Options {
     static bool show_version;
     static bool show_help;
     static bool reuse_context;
+    static bool prefetch_assets;
     static bool run_forever;
+    static unsigned int repeat;
+    static RepeatOrder repeat_order;
     static bool annotate;
     static unsigned int offscreen;
     static GLVisualConfig visual_config;
     static bool good_config;
     static Results results;
     static std::string results_file;
+    static bool results_frames;
+    static std::string results_stream;
+    static unsigned int results_stream_frames;
+    static std::string trace_file;
+    static std::string frame_log;
+    static std::string frame_log_dump;
+    static FrameLogFormat frame_log_format;
+    static std::string metrics_file;
+    static double metrics_interval;
+    static std::string baseline;
+    static double max_regression;
+    static bool compare;
+    static std::vector<std::string> compare_files;
+    static CompareFormat compare_format;
+    static std::string program_cache;
+    static ProgramCacheMode program_cache_mode;
+    static std::string mesh_cache;
     static std::vector<WindowSystemOption> winsys_options;
     static std::string winsys_options_help;
 };
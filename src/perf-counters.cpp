@@ -0,0 +1,243 @@
+/*
+ * Copyright © 2026 Collabora Limited
+ *
+ * This file is part of the glmark2 OpenGL (ES) 2.0 benchmark.
+ *
+ * glmark2 is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * glmark2 is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * glmark2.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "perf-counters.h"
+#include "log.h"
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <sys/types.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#endif
+
+#if defined(__linux__)
+namespace
+{
+
+struct CounterConfig {
+    uint32_t type;
+    uint64_t config;
+};
+
+const CounterConfig counter_configs[PerfCounters::CounterCount] = {
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+    {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES},
+    {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS},
+    {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK},
+};
+
+int
+perf_event_open(const CounterConfig &config, pid_t tid, bool exclude_kernel)
+{
+    struct perf_event_attr attr;
+
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = config.type;
+    attr.config = config.config;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED |
+                       PERF_FORMAT_TOTAL_TIME_RUNNING;
+    /* Also count in the threads created by this thread from now on */
+    attr.inherit = 1;
+    attr.exclude_kernel = exclude_kernel;
+    attr.exclude_hv = exclude_kernel;
+
+    return syscall(__NR_perf_event_open, &attr, tid, -1, -1, PERF_FLAG_FD_CLOEXEC);
+}
+
+/**
+ * Gets the ids of all the threads of this process.
+ */
+std::vector<pid_t>
+get_thread_ids()
+{
+    std::vector<pid_t> tids;
+    DIR *dir = opendir("/proc/self/task");
+
+    if (!dir) {
+        tids.push_back(getpid());
+        return tids;
+    }
+
+    while (struct dirent *entry = readdir(dir)) {
+        if (entry->d_name[0] != '.')
+            tids.push_back(atoi(entry->d_name));
+    }
+
+    closedir(dir);
+
+    return tids;
+}
+
+}
+#endif
+
+PerfCounters::PerfCounters() : active_(false)
+{
+    for (int i = 0; i < CounterCount; i++) {
+        available_[i] = false;
+        baseline_[i] = 0.0;
+        values_[i] = 0.0;
+    }
+}
+
+PerfCounters::~PerfCounters()
+{
+    close_events();
+}
+
+const char *
+PerfCounters::name(Counter counter)
+{
+    static const char *names[CounterCount] = {
+        "cycles", "instructions", "cache_misses", "branch_misses",
+        "context_switches", "page_faults", "task_clock"
+    };
+
+    return names[counter];
+}
+
+bool
+PerfCounters::start()
+{
+    close_events();
+
+    for (int i = 0; i < CounterCount; i++) {
+        available_[i] = false;
+        baseline_[i] = 0.0;
+        values_[i] = 0.0;
+    }
+
+#if defined(__linux__)
+    std::vector<pid_t> tids = get_thread_ids();
+
+    /*
+     * Count kernel events too if allowed, since the driver spends time in
+     * the kernel. Otherwise fall back to counting user space events only,
+     * which is allowed by the default perf_event_paranoid setting.
+     */
+    bool exclude_kernel = false;
+
+    for (int i = 0; i < CounterCount; i++) {
+        for (auto tid : tids) {
+            int fd = perf_event_open(counter_configs[i], tid, exclude_kernel);
+            if (fd < 0 && !exclude_kernel && (errno == EACCES || errno == EPERM)) {
+                exclude_kernel = true;
+                fd = perf_event_open(counter_configs[i], tid, exclude_kernel);
+            }
+
+            /* Threads may exit while we are opening events for them */
+            if (fd < 0)
+                continue;
+
+            events_.push_back({static_cast<Counter>(i), fd});
+            available_[i] = true;
+        }
+    }
+
+    /*
+     * Context switches always happen in the kernel, so they read 0 when
+     * only counting user space events, and are reported as unavailable.
+     */
+    if (exclude_kernel) {
+        for (auto it = events_.begin(); it != events_.end();) {
+            if (it->counter == CounterContextSwitches) {
+                close(it->fd);
+                it = events_.erase(it);
+            }
+            else {
+                ++it;
+            }
+        }
+        available_[CounterContextSwitches] = false;
+
+        Log::debug("Counting only user space performance events\n");
+    }
+#endif
+
+    active_ = !events_.empty();
+
+    return active_;
+}
+
+void
+PerfCounters::restart()
+{
+    if (!active_)
+        return;
+
+    read_values(baseline_);
+}
+
+void
+PerfCounters::stop()
+{
+    if (!active_)
+        return;
+
+    read_values(values_);
+
+    for (int i = 0; i < CounterCount; i++)
+        values_[i] -= baseline_[i];
+
+    close_events();
+    active_ = false;
+}
+
+void
+PerfCounters::read_values(double *values)
+{
+    for (int i = 0; i < CounterCount; i++)
+        values[i] = 0.0;
+
+#if defined(__linux__)
+    for (auto &event : events_) {
+        uint64_t data[3] = {0, 0, 0};
+
+        if (read(event.fd, data, sizeof(data)) != sizeof(data))
+            continue;
+
+        /* Scale the count if the counter was multiplexed with others */
+        double count = data[0];
+        if (data[2] > 0 && data[2] < data[1])
+            count *= static_cast<double>(data[1]) / data[2];
+
+        values[event.counter] += count;
+    }
+#endif
+}
+
+void
+PerfCounters::close_events()
+{
+#if defined(__linux__)
+    for (auto &event : events_)
+        close(event.fd);
+#endif
+
+    events_.clear();
+}
@@ -0,0 +1,107 @@
+/*
+ * Copyright © 2026 Collabora Limited
+ *
+ * This file is part of the glmark2 OpenGL (ES) 2.0 benchmark.
+ *
+ * glmark2 is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * glmark2 is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * glmark2.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef GLMARK2_PERF_COUNTERS_H_
+#define GLMARK2_PERF_COUNTERS_H_
+
+#include <vector>
+#include <stdint.h>
+
+/**
+ * Counts CPU performance events for the whole process using perf_event_open.
+ *
+ * Events are counted for all the threads that exist when counting starts and
+ * for all the threads they create afterwards, so work done in driver threads
+ * is included. Counters that can't be opened (e.g. hardware counters in a VM
+ * without a PMU) are reported as unavailable, while the rest keep working.
+ *
+ * Only supported on Linux.
+ */
+class PerfCounters
+{
+public:
+    enum Counter {
+        CounterCycles,
+        CounterInstructions,
+        CounterCacheMisses,
+        CounterBranchMisses,
+        CounterContextSwitches,
+        CounterPageFaults,
+        CounterTaskClock,
+        CounterCount
+    };
+
+    PerfCounters();
+    ~PerfCounters();
+
+    /**
+     * Gets the name of a counter, as used in the results.
+     */
+    static const char *name(Counter counter);
+
+    /**
+     * Starts counting.
+     *
+     * @return whether at least one counter could be started
+     */
+    bool start();
+
+    /**
+     * Discards the events counted so far, without stopping counting.
+     */
+    void restart();
+
+    /**
+     * Stops counting and reads the final counter values.
+     */
+    void stop();
+
+    /**
+     * Whether counting is in progress.
+     */
+    bool active() const { return active_; }
+
+    /**
+     * Whether a counter was available in the last run.
+     */
+    bool available(Counter counter) const { return available_[counter]; }
+
+    /**
+     * Gets the value of a counter in the last run, scaled to account for
+     * the time the counter wasn't scheduled on the PMU. The task clock is
+     * in nanoseconds.
+     */
+    double value(Counter counter) const { return values_[counter]; }
+
+private:
+    struct Event {
+        Counter counter;
+        int fd;
+    };
+
+    void read_values(double *values);
+    void close_events();
+
+    bool active_;
+    std::vector<Event> events_;
+    bool available_[CounterCount];
+    double baseline_[CounterCount];
+    double values_[CounterCount];
+};
+
+#endif /* GLMARK2_PERF_COUNTERS_H_ */
@@ -0,0 +1,282 @@
+/*
+ * Copyright © 2026 Collabora Limited
+ *
+ * This file is part of the glmark2 OpenGL (ES) 2.0 benchmark.
+ *
+ * glmark2 is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * glmark2 is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * glmark2.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "program-cache.h"
+#include "gl-headers.h"
+#include "log.h"
+#include "program.h"
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+namespace
+{
+
+const char cache_magic[8] = {'G', 'L', 'M', '2', 'P', 'B', 'I', 'N'};
+const uint32_t cache_version = 1;
+
+/* The header of a cache file, followed by the program binary */
+struct CacheHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t format;
+    uint64_t key;
+    uint32_t vtx_size;
+    uint32_t frg_size;
+    uint32_t binary_size;
+    uint32_t reserved;
+};
+
+std::filesystem::path cache_dir;
+ProgramCache::Mode cache_mode = ProgramCache::ModeUse;
+std::string driver_id;
+unsigned int hits = 0;
+unsigned int misses = 0;
+unsigned int bypassed = 0;
+unsigned int stored = 0;
+
+/* 64-bit FNV-1a */
+uint64_t
+hash_append(uint64_t hash, const std::string &str)
+{
+    for (auto c : str) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 0x100000001b3ULL;
+    }
+
+    /* Separate the strings, so that moving text between them changes the hash */
+    hash ^= 0xff;
+    hash *= 0x100000001b3ULL;
+
+    return hash;
+}
+
+std::string
+gl_string(GLenum name)
+{
+    const char *str = reinterpret_cast<const char *>(glGetString(name));
+    return str ? str : "";
+}
+
+uint64_t
+cache_key(const std::string &vtx_shader, const std::string &frg_shader)
+{
+    /* The driver can't change while running, so only query it once */
+    if (driver_id.empty()) {
+        driver_id = gl_string(GL_VENDOR) + "\n" + gl_string(GL_RENDERER) +
+                    "\n" + gl_string(GL_VERSION);
+    }
+
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    hash = hash_append(hash, driver_id);
+    hash = hash_append(hash, vtx_shader);
+    hash = hash_append(hash, frg_shader);
+
+    return hash;
+}
+
+std::filesystem::path
+cache_path(uint64_t key)
+{
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.bin", static_cast<unsigned long long>(key));
+    return cache_dir / name;
+}
+
+bool
+binary_supported()
+{
+    return GLExtensions::GetProgramBinary && GLExtensions::ProgramBinary;
+}
+
+}
+
+bool ProgramCache::enabled_ = false;
+
+bool
+ProgramCache::init(const std::string &dir, Mode mode)
+{
+    if (dir.empty())
+        return true;
+
+    std::error_code ec;
+    std::filesystem::create_directories(dir, ec);
+    if (ec) {
+        Log::error("Failed to create program cache directory %s: %s\n",
+                   dir.c_str(), ec.message().c_str());
+        return false;
+    }
+
+    cache_dir = dir;
+    cache_mode = mode;
+    enabled_ = true;
+
+    return true;
+}
+
+bool
+ProgramCache::load(Program &program, const std::string &vtx_shader,
+                   const std::string &frg_shader)
+{
+    if (!binary_supported())
+        return false;
+
+    /* The hint may change how programs are built, so leave it out when bypassing */
+    if (cache_mode == ModeBypass) {
+        bypassed++;
+        return false;
+    }
+
+    /* Binaries can only be retrieved if the driver knows about it before linking */
+    if (GLExtensions::ProgramParameteri) {
+        GLExtensions::ProgramParameteri(program.handle(),
+                                        GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+
+    if (cache_mode != ModeUse) {
+        bypassed++;
+        return false;
+    }
+
+    uint64_t key = cache_key(vtx_shader, frg_shader);
+    std::filesystem::path path = cache_path(key);
+    std::ifstream ifs(path, std::ios::binary);
+    CacheHeader header;
+
+    if (!ifs.read(reinterpret_cast<char *>(&header), sizeof(header)) ||
+        memcmp(header.magic, cache_magic, sizeof(cache_magic)) != 0 ||
+        header.version != cache_version || header.key != key ||
+        header.vtx_size != vtx_shader.size() || header.frg_size != frg_shader.size())
+    {
+        misses++;
+        return false;
+    }
+
+    std::vector<char> binary(header.binary_size);
+    if (!ifs.read(binary.data(), binary.size())) {
+        misses++;
+        return false;
+    }
+
+    GLExtensions::ProgramBinary(program.handle(), header.format,
+                                binary.data(), binary.size());
+    program.buildFromLinked();
+
+    /* The driver may reject binaries, e.g. after an update that kept the version */
+    if (!program.ready()) {
+        Log::debug("Program cache: rejected binary %s\n", path.string().c_str());
+        misses++;
+
+        /* Start over with a fresh program object for building from the sources */
+        program.release();
+        program.init();
+        if (GLExtensions::ProgramParameteri) {
+            GLExtensions::ProgramParameteri(program.handle(),
+                                            GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+        }
+        return false;
+    }
+
+    Log::debug("Program cache: loaded %s\n", path.string().c_str());
+    hits++;
+
+    return true;
+}
+
+void
+ProgramCache::store(Program &program, const std::string &vtx_shader,
+                    const std::string &frg_shader)
+{
+    if (!binary_supported() || cache_mode == ModeBypass || !program.ready())
+        return;
+
+    GLint length = 0;
+    glGetProgramiv(program.handle(), GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0)
+        return;
+
+    std::vector<char> binary(length);
+    GLenum format = 0;
+    GLsizei written = 0;
+    GLExtensions::GetProgramBinary(program.handle(), length, &written, &format,
+                                   binary.data());
+    if (written <= 0)
+        return;
+
+    uint64_t key = cache_key(vtx_shader, frg_shader);
+    CacheHeader header;
+
+    memcpy(header.magic, cache_magic, sizeof(cache_magic));
+    header.version = cache_version;
+    header.format = format;
+    header.key = key;
+    header.vtx_size = vtx_shader.size();
+    header.frg_size = frg_shader.size();
+    header.binary_size = written;
+    header.reserved = 0;
+
+    /* Write to a temporary file and rename it, so readers never see a partial file */
+    std::filesystem::path path = cache_path(key);
+    std::filesystem::path tmp_path = path;
+    tmp_path += ".tmp";
+
+    {
+        std::ofstream ofs(tmp_path, std::ios::binary | std::ios::trunc);
+        ofs.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        ofs.write(binary.data(), written);
+        if (!ofs) {
+            Log::debug("Program cache: failed to write %s\n", tmp_path.string().c_str());
+            return;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tmp_path, path, ec);
+    if (ec) {
+        Log::debug("Program cache: failed to rename %s: %s\n",
+                   tmp_path.string().c_str(), ec.message().c_str());
+        return;
+    }
+
+    Log::debug("Program cache: stored %s\n", path.string().c_str());
+    stored++;
+}
+
+void
+ProgramCache::log_summary()
+{
+    if (!enabled_)
+        return;
+
+    if (!binary_supported()) {
+        Log::info("Program cache: not supported by the driver\n");
+        return;
+    }
+
+    if (cache_mode == ModeUse) {
+        Log::info("Program cache: %u hits, %u misses, %u stored\n",
+                  hits, misses, stored);
+    }
+    else {
+        Log::info("Program cache: %u programs built from sources, %u stored\n",
+                  bypassed, stored);
+    }
+}
@@ -0,0 +1,97 @@
+/*
+ * Copyright © 2026 Collabora Limited
+ *
+ * This file is part of the glmark2 OpenGL (ES) 2.0 benchmark.
+ *
+ * glmark2 is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * glmark2 is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * glmark2.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef GLMARK2_PROGRAM_CACHE_H_
+#define GLMARK2_PROGRAM_CACHE_H_
+
+#include <string>
+
+class Program;
+
+/**
+ * A persistent on-disk cache of linked program binaries.
+ *
+ * Programs are stored with glGetProgramBinary() (GL_ARB_get_program_binary
+ * or GL_OES_get_program_binary) in a file named after a hash of the shader
+ * sources and the GL vendor, renderer and version strings, so binaries are
+ * never loaded into a different driver. Binaries the driver rejects are
+ * rebuilt from the sources and replaced.
+ */
+class ProgramCache
+{
+public:
+    enum Mode {
+        /** Load cached programs, and cache programs built from sources */
+        ModeUse,
+        /** Always build programs from sources, without using the cache */
+        ModeBypass,
+        /** Always build programs from sources, replacing the cached ones */
+        ModeRefresh
+    };
+
+    /**
+     * Starts caching programs.
+     *
+     * @param dir the cache directory, which is created if needed, or an
+     *            empty string to disable caching
+     * @param mode how to use the cache
+     *
+     * @return whether the operation succeeded
+     */
+    static bool init(const std::string &dir, Mode mode);
+
+    /**
+     * Whether caching is enabled.
+     */
+    static bool enabled() { return enabled_; }
+
+    /**
+     * Tries to load a program from the cache.
+     *
+     * If the program is not loaded, prepares it for caching after it has
+     * been built from the sources.
+     *
+     * @param program an initialized program without any shaders
+     * @param vtx_shader the vertex shader source
+     * @param frg_shader the fragment shader source
+     *
+     * @return whether the program was loaded, and is ready to use
+     */
+    static bool load(Program &program, const std::string &vtx_shader,
+                     const std::string &frg_shader);
+
+    /**
+     * Stores a program built from the sources in the cache.
+     *
+     * @param program a ready program, passed to load() before it was built
+     * @param vtx_shader the vertex shader source
+     * @param frg_shader the fragment shader source
+     */
+    static void store(Program &program, const std::string &vtx_shader,
+                      const std::string &frg_shader);
+
+    /**
+     * Logs the number of cache hits and misses.
+     */
+    static void log_summary();
+
+private:
+    static bool enabled_;
+};
+
+#endif /* GLMARK2_PROGRAM_CACHE_H_ */
@@ -0,0 +1,335 @@
+/*
+ * Copyright © 2026 Collabora Limited
+ *
+ * This file is part of the glmark2 OpenGL (ES) 2.0 benchmark.
+ *
+ * glmark2 is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * glmark2 is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * glmark2.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "results-compare.h"
+#include "log.h"
+#include "results-file.h"
+#include "results-reader.h"
+#include "statistics.h"
+#include "util.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <unordered_map>
+
+namespace
+{
+
+/* The results of all the runs of a benchmark in a file */
+struct BenchmarkRuns {
+    std::string name;
+    /* The average frame time (in ms) of each run */
+    std::vector<double> run_frame_times;
+    /* The time (in ms) of each frame of all the runs, sorted */
+    std::vector<double> frame_times;
+    RunningStats frame_stats;
+};
+
+struct FileResults {
+    /* The benchmarks in the order they first appear in the file */
+    std::vector<BenchmarkRuns> benchmarks;
+    std::unordered_map<std::string, size_t> index;
+};
+
+struct BenchmarkComparison {
+    std::string name;
+    /* The average frame times in ms */
+    double base_frame_time;
+    double frame_time;
+    /* The relative change of the average frame time and its 95% CI */
+    double change;
+    double ci95;
+    /* The p-value, or a negative value if there are too few samples */
+    double p_value;
+};
+
+struct FileComparison {
+    std::string file;
+    std::vector<BenchmarkComparison> benchmarks;
+    std::vector<std::string> only_in_reference;
+    std::vector<std::string> only_in_file;
+    double geomean_change;
+    unsigned int slower;
+    unsigned int faster;
+};
+
+bool
+load_results(const std::string &file, FileResults &results)
+{
+    bool ok = ResultsReader::read(file, [&results](const BenchmarkResult &result) {
+        double frame_time = result.average_frame_time();
+
+        if (result.status != "Success" || frame_time <= 0.0)
+            return;
+
+        auto iter = results.index.find(result.name);
+        if (iter == results.index.end()) {
+            iter = results.index.emplace(result.name, results.benchmarks.size()).first;
+            results.benchmarks.emplace_back();
+            results.benchmarks.back().name = result.name;
+        }
+
+        BenchmarkRuns &runs = results.benchmarks[iter->second];
+        runs.run_frame_times.push_back(frame_time);
+        runs.frame_times.insert(runs.frame_times.end(),
+                                result.frame_times.begin(),
+                                result.frame_times.end());
+        for (auto t : result.frame_times)
+            runs.frame_stats.add(t);
+    });
+
+    if (!ok)
+        return false;
+
+    for (auto &runs : results.benchmarks)
+        std::sort(runs.frame_times.begin(), runs.frame_times.end());
+
+    return true;
+}
+
+BenchmarkComparison
+compare_benchmark(const BenchmarkRuns &base, const BenchmarkRuns &runs)
+{
+    BenchmarkComparison comparison;
+    RunningStats base_stats;
+    RunningStats stats;
+
+    comparison.name = base.name;
+    comparison.p_value = -1.0;
+
+    /*
+     * Prefer the per-frame samples, and fall back to the per-run averages
+     * if the frame times weren't saved in both files.
+     */
+    if (!base.frame_times.empty() && !runs.frame_times.empty()) {
+        base_stats = base.frame_stats;
+        stats = runs.frame_stats;
+        comparison.p_value = Statistics::mann_whitney_p_value(base.frame_times,
+                                                              runs.frame_times);
+    }
+    else {
+        std::vector<double> base_sorted(base.run_frame_times);
+        std::vector<double> sorted(runs.run_frame_times);
+
+        for (auto t : base_sorted)
+            base_stats.add(t);
+        for (auto t : sorted)
+            stats.add(t);
+
+        if (base_sorted.size() > 1 && sorted.size() > 1) {
+            std::sort(base_sorted.begin(), base_sorted.end());
+            std::sort(sorted.begin(), sorted.end());
+            comparison.p_value = Statistics::mann_whitney_p_value(base_sorted, sorted);
+        }
+    }
+
+    comparison.base_frame_time = base_stats.mean();
+    comparison.frame_time = stats.mean();
+    comparison.change = comparison.frame_time / comparison.base_frame_time - 1.0;
+    comparison.ci95 = Statistics::welch_ci95_half_width(base_stats, stats) /
+                      comparison.base_frame_time;
+
+    return comparison;
+}
+
+bool
+significant(const BenchmarkComparison &comparison)
+{
+    return comparison.p_value >= 0.0 && comparison.p_value < 0.05;
+}
+
+FileComparison
+compare_files(const FileResults &base, const std::string &file,
+              const FileResults &results)
+{
+    FileComparison comparison;
+    double log_ratio_sum = 0.0;
+
+    comparison.file = file;
+    comparison.slower = 0;
+    comparison.faster = 0;
+
+    for (auto const& base_runs : base.benchmarks) {
+        auto iter = results.index.find(base_runs.name);
+        if (iter == results.index.end()) {
+            comparison.only_in_reference.push_back(base_runs.name);
+            continue;
+        }
+
+        BenchmarkComparison bc = compare_benchmark(base_runs,
+                                                   results.benchmarks[iter->second]);
+        log_ratio_sum += std::log(bc.frame_time / bc.base_frame_time);
+
+        if (significant(bc) && bc.change > 0.0)
+            comparison.slower++;
+        else if (significant(bc) && bc.change < 0.0)
+            comparison.faster++;
+
+        comparison.benchmarks.push_back(bc);
+    }
+
+    for (auto const& runs : results.benchmarks) {
+        if (base.index.find(runs.name) == base.index.end())
+            comparison.only_in_file.push_back(runs.name);
+    }
+
+    comparison.geomean_change = comparison.benchmarks.empty() ? 0.0 :
+        std::exp(log_ratio_sum / comparison.benchmarks.size()) - 1.0;
+
+    return comparison;
+}
+
+std::string
+format_change(double change)
+{
+    return (change >= 0.0 ? "+" : "") + Util::toString(100.0 * change, 2) + "%";
+}
+
+void
+log_text(const std::string &reference, const FileComparison &comparison)
+{
+    Log::info("=======================================================\n");
+    Log::info("    Reference: %s\n", reference.c_str());
+    Log::info("    Compared:  %s\n", comparison.file.c_str());
+    Log::info("=======================================================\n");
+    Log::info("    %10s %10s %9s %9s %8s  %s\n",
+              "Base (ms)", "New (ms)", "Change", "CI95", "p-value", "Benchmark");
+
+    for (auto const& bc : comparison.benchmarks) {
+        std::string ci95 = bc.ci95 > 0.0 ?
+            "+-" + Util::toString(100.0 * bc.ci95, 2) + "%" : "n/a";
+        std::string p_value = "n/a";
+
+        if (bc.p_value >= 0.0)
+            p_value = bc.p_value < 0.001 ? "<0.001" : Util::toString(bc.p_value, 3);
+
+        Log::info("    %10s %10s %9s %9s %8s%s %s\n",
+                  Util::toString(bc.base_frame_time, 3).c_str(),
+                  Util::toString(bc.frame_time, 3).c_str(),
+                  format_change(bc.change).c_str(), ci95.c_str(), p_value.c_str(),
+                  significant(bc) ? "*" : " ", bc.name.c_str());
+    }
+
+    Log::info("=======================================================\n");
+    Log::info("    Geometric mean change: %s (%u benchmarks)\n",
+              format_change(comparison.geomean_change).c_str(),
+              static_cast<unsigned>(comparison.benchmarks.size()));
+    Log::info("    Significantly slower: %u, faster: %u (* p < 0.05)\n",
+              comparison.slower, comparison.faster);
+
+    for (auto const& name : comparison.only_in_reference)
+        Log::info("    Only in reference: %s\n", name.c_str());
+    for (auto const& name : comparison.only_in_file)
+        Log::info("    Only in %s: %s\n", comparison.file.c_str(), name.c_str());
+
+    Log::info("=======================================================\n");
+}
+
+void
+write_json_names(std::ostream &os, const std::vector<std::string> &names)
+{
+    os << "[";
+    for (size_t i = 0; i < names.size(); i++)
+        os << (i > 0 ? ", " : "") << "\"" << ResultsFile::json_escape(names[i]) << "\"";
+    os << "]";
+}
+
+void
+write_json(std::ostream &os, const FileComparison &comparison, bool last)
+{
+    os << "    {" << std::endl;
+    os << "      \"file\": \"" << ResultsFile::json_escape(comparison.file) << "\"," << std::endl;
+    os << "      \"benchmarks\": [";
+
+    for (size_t i = 0; i < comparison.benchmarks.size(); i++) {
+        const BenchmarkComparison &bc = comparison.benchmarks[i];
+
+        os << (i > 0 ? "," : "") << std::endl;
+        os << "        {\"name\": \"" << ResultsFile::json_escape(bc.name) << "\""
+           << ", \"base_frame_time\": " << bc.base_frame_time
+           << ", \"frame_time\": " << bc.frame_time
+           << ", \"change\": " << bc.change
+           << ", \"ci95\": ";
+        if (bc.ci95 > 0.0)
+            os << bc.ci95;
+        else
+            os << "null";
+        os << ", \"p_value\": ";
+        if (bc.p_value >= 0.0)
+            os << bc.p_value;
+        else
+            os << "null";
+        os << ", \"significant\": " << (significant(bc) ? "true" : "false") << "}";
+    }
+
+    os << std::endl << "      ]," << std::endl;
+    os << "      \"geomean_change\": " << comparison.geomean_change << "," << std::endl;
+    os << "      \"slower\": " << comparison.slower << "," << std::endl;
+    os << "      \"faster\": " << comparison.faster << "," << std::endl;
+    os << "      \"only_in_reference\": ";
+    write_json_names(os, comparison.only_in_reference);
+    os << "," << std::endl;
+    os << "      \"only_in_file\": ";
+    write_json_names(os, comparison.only_in_file);
+    os << std::endl;
+    os << "    }" << (last ? "" : ",") << std::endl;
+}
+
+}
+
+bool
+ResultsCompare::run(const std::vector<std::string> &files, Format format)
+{
+    if (files.size() < 2) {
+        Log::error("At least two results files are needed for a comparison\n");
+        return false;
+    }
+
+    FileResults base;
+    if (!load_results(files[0], base))
+        return false;
+
+    if (format == FormatJSON) {
+        std::cout << "{" << std::endl;
+        std::cout << "  \"reference\": \"" << ResultsFile::json_escape(files[0]) << "\","
+                  << std::endl;
+        std::cout << "  \"comparisons\": [" << std::endl;
+    }
+
+    /* Only keep one of the compared files in memory at a time */
+    for (size_t i = 1; i < files.size(); i++) {
+        FileResults results;
+        if (!load_results(files[i], results))
+            return false;
+
+        FileComparison comparison = compare_files(base, files[i], results);
+
+        if (format == FormatJSON)
+            write_json(std::cout, comparison, i == files.size() - 1);
+        else
+            log_text(files[0], comparison);
+    }
+
+    if (format == FormatJSON) {
+        std::cout << "  ]" << std::endl;
+        std::cout << "}" << std::endl;
+    }
+
+    return true;
+}
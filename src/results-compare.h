@@ -0,0 +1,53 @@
+/*
+ * Copyright © 2026 Collabora Limited
+ *
+ * This file is part of the glmark2 OpenGL (ES) 2.0 benchmark.
+ *
+ * glmark2 is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * glmark2 is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * glmark2.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef GLMARK2_RESULTS_COMPARE_H_
+#define GLMARK2_RESULTS_COMPARE_H_
+
+#include <string>
+#include <vector>
+
+/**
+ * Compares the results of two or more JSON results files.
+ *
+ * The first file is the reference. The benchmarks of every other file are
+ * paired with the benchmarks of the reference by name, and the change of
+ * their average frame time is reported together with its 95% confidence
+ * interval and the p-value of the Mann-Whitney U test on the per-frame
+ * samples (or on the per-run averages, if the frame times weren't saved).
+ */
+class ResultsCompare
+{
+public:
+    enum Format {
+        FormatText,
+        FormatJSON
+    };
+
+    /**
+     * Compares the results files and prints the comparison to stdout.
+     *
+     * @param files the results files, the first one being the reference
+     * @param format the output format
+     *
+     * @return whether the operation succeeded
+     */
+    static bool run(const std::vector<std::string> &files, Format format);
+};
+
+#endif /* GLMARK2_RESULTS_COMPARE_H_ */
@@ -22,7 +22,14 @@
 
 #include "results-file.h"
 #include "log.h"
-
+#include "stream-writer.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
 #include <fstream>
 #include <sstream>
 
@@ -39,6 +46,8 @@ public:
     void end_info() override {}
     void begin_benchmark() override {}
     void end_benchmark() override {}
+    void begin_summary() override {}
+    void end_summary() override {}
     void add_field(const std::string &name, const std::string &value) override
     {
         static_cast<void>(name);
@@ -92,6 +101,16 @@ public:
         fs << std::endl;
     }
 
+    void begin_summary() override
+    {
+        first_field = true;
+    }
+
+    void end_summary() override
+    {
+        fs << std::endl;
+    }
+
     void add_field(const std::string &name, const std::string &value) override
     {
         static_cast<void>(name);
@@ -160,6 +179,16 @@ public:
         fs << "  </benchmark>" << std::endl;
     }
 
+    void begin_summary() override
+    {
+        fs << "  <summary>" << std::endl;
+    }
+
+    void end_summary() override
+    {
+        fs << "  </summary>" << std::endl;
+    }
+
     void add_field(const std::string &name, const std::string &value) override
     {
         std::string escaped = xml_text_escape(value);
@@ -170,6 +199,407 @@ private:
     std::ofstream fs;
 };
 
+std::string json_number(double d)
+{
+    if (!std::isfinite(d))
+        return "null";
+
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%.9g", d);
+    return buf;
+}
+
+/*
+ * Whether a string matches the JSON number grammar:
+ * -?(0|[1-9][0-9]*)(\.[0-9]+)?([eE][+-]?[0-9]+)?
+ */
+bool is_json_number(const std::string &str)
+{
+    size_t i = 0;
+    auto digits = [&str, &i]() {
+        size_t start = i;
+        while (i < str.size() && isdigit(static_cast<unsigned char>(str[i])))
+            i++;
+        return i - start;
+    };
+
+    if (i < str.size() && str[i] == '-')
+        i++;
+
+    if (i < str.size() && str[i] == '0')
+        i++;
+    else if (digits() == 0)
+        return false;
+
+    if (i < str.size() && str[i] == '.') {
+        i++;
+        if (digits() == 0)
+            return false;
+    }
+
+    if (i < str.size() && (str[i] == 'e' || str[i] == 'E')) {
+        i++;
+        if (i < str.size() && (str[i] == '+' || str[i] == '-'))
+            i++;
+        if (digits() == 0)
+            return false;
+    }
+
+    return i == str.size();
+}
+
+/*
+ * Converts a field value to a JSON value. Field values are formatted by the
+ * callers, so numbers are written as JSON numbers and unavailable values
+ * ("n/a") as null. Numbers not in JSON form (e.g. ".5" or "00.5" from the
+ * command line) are normalized.
+ */
+std::string json_value(const std::string &str)
+{
+    if (str == "n/a")
+        return "null";
+
+    if (is_json_number(str))
+        return str;
+
+    if (!str.empty() &&
+        str.find_first_not_of("0123456789+-.eE") == std::string::npos)
+    {
+        char *end;
+        double d = strtod(str.c_str(), &end);
+        if (*end == '\0' && std::isfinite(d))
+            return json_number(d);
+    }
+
+    return "\"" + ResultsFile::json_escape(str) + "\"";
+}
+
+class JSONResultsFile : public ResultsFile
+{
+public:
+    JSONResultsFile(std::ofstream &&fs) : fs{std::move(fs)} {}
+
+    std::string type() override { return "JSON"; }
+
+    void begin() override
+    {
+        info.clear();
+        benchmarks.clear();
+        summaries.clear();
+    }
+
+    /*
+     * The whole document is kept in memory and only written out here, so
+     * writing results never does file I/O while benchmarks are running.
+     */
+    void end() override
+    {
+        fs << "{\n"
+           << "  \"info\": {" << info << "\n  },\n"
+           << "  \"benchmarks\": [" << benchmarks << "\n  ],\n"
+           << "  \"summaries\": [" << summaries << "\n  ]\n"
+           << "}" << std::endl;
+    }
+
+    void begin_info() override
+    {
+        current = &info;
+        first_field = true;
+    }
+
+    void end_info() override
+    {
+        current = nullptr;
+    }
+
+    void begin_benchmark() override
+    {
+        begin_object(benchmarks);
+    }
+
+    void end_benchmark() override
+    {
+        end_object();
+    }
+
+    void begin_summary() override
+    {
+        begin_object(summaries);
+    }
+
+    void end_summary() override
+    {
+        end_object();
+    }
+
+    void add_field(const std::string &name, const std::string &value) override
+    {
+        /* Info fields are descriptive (e.g. the version), so keep them as strings */
+        if (current == &info)
+            add_raw_field(name, "\"" + ResultsFile::json_escape(value) + "\"");
+        else
+            add_raw_field(name, json_value(value));
+    }
+
+    void add_options(const std::map<std::string, std::string> &options) override
+    {
+        std::string object{"{"};
+        bool first = true;
+
+        for (auto const& opt : options)
+        {
+            object += (first ? "" : ", ");
+            object += "\"" + ResultsFile::json_escape(opt.first) + "\": " + json_value(opt.second);
+            first = false;
+        }
+
+        add_raw_field("options", object + "}");
+    }
+
+    void add_array(const std::string &name, const std::vector<double> &values) override
+    {
+        std::string array{"["};
+
+        array.reserve(values.size() * 8);
+        for (size_t i = 0; i < values.size(); i++)
+        {
+            if (i > 0)
+                array += ",";
+            array += json_number(values[i]);
+        }
+
+        add_raw_field(name, array + "]");
+    }
+
+private:
+    void begin_object(std::string &list)
+    {
+        list += list.empty() ? "\n    {" : ",\n    {";
+        current = &list;
+        first_field = true;
+    }
+
+    void end_object()
+    {
+        if (current)
+            *current += "\n    }";
+        current = nullptr;
+    }
+
+    void add_raw_field(const std::string &name, const std::string &value)
+    {
+        if (!current)
+            return;
+
+        /* Info fields are one level less deep than benchmark fields */
+        const char *indent = current == &info ? "\n    " : "\n      ";
+
+        *current += (first_field ? "" : ",");
+        *current += indent;
+        *current += "\"" + ResultsFile::json_escape(name) + "\": " + value;
+        first_field = false;
+    }
+
+    std::ofstream fs;
+    std::string info;
+    std::string benchmarks;
+    std::string summaries;
+    std::string *current = nullptr;
+    bool first_field = true;
+};
+
+/*
+ * Writes each info, benchmark and summary object as a single line of JSON
+ * as soon as it is complete, plus a line with the frame time statistics
+ * every frame_interval frames.
+ */
+class StreamResultsFile : public ResultsFile
+{
+public:
+    StreamResultsFile(std::unique_ptr<StreamWriter> writer, unsigned int frame_interval) :
+        writer{std::move(writer)}, frame_interval{frame_interval} {}
+
+    std::string type() override { return "JSON stream"; }
+
+    void begin() override {}
+
+    void end() override
+    {
+        if (!writer)
+            return;
+
+        writer->write("{\"type\": \"end\", \"timestamp\": " + timestamp() + "}\n");
+        /* Wait for the writer thread to finish writing */
+        writer.reset();
+    }
+
+    void begin_info() override { begin_object("info"); }
+    void end_info() override { end_object(); }
+
+    void begin_benchmark() override
+    {
+        begin_object("benchmark");
+        benchmark_name.clear();
+        frames = 0;
+        reset_interval();
+    }
+
+    void end_benchmark() override { end_object(); }
+    void begin_summary() override { begin_object("summary"); }
+    void end_summary() override { end_object(); }
+
+    void add_field(const std::string &name, const std::string &value) override
+    {
+        if (name == "name")
+            benchmark_name = value;
+
+        add_raw_field(name, json_value(value));
+    }
+
+    void add_options(const std::map<std::string, std::string> &options) override
+    {
+        std::string object{"{"};
+        bool first = true;
+
+        for (auto const& opt : options)
+        {
+            object += (first ? "" : ", ");
+            object += "\"" + ResultsFile::json_escape(opt.first) + "\": " + json_value(opt.second);
+            first = false;
+        }
+
+        add_raw_field("options", object + "}");
+    }
+
+    /* Per-frame arrays are covered by the frame lines */
+
+    void add_frame(double frame_time) override
+    {
+        if (frame_interval == 0 || !writer)
+            return;
+
+        frames++;
+        interval_frames++;
+        interval_time += frame_time;
+        interval_max_time = std::max(interval_max_time, frame_time);
+
+        if (interval_frames < frame_interval)
+            return;
+
+        double average = interval_time / interval_frames;
+
+        writer->write("{\"type\": \"frames\", \"timestamp\": " + timestamp() +
+                      ", \"name\": \"" + ResultsFile::json_escape(benchmark_name) + "\"" +
+                      ", \"frame\": " + std::to_string(frames) +
+                      ", \"fps\": " + json_number(1.0 / average) +
+                      ", \"frame_time\": " + json_number(1000.0 * average) +
+                      ", \"frame_time_max\": " + json_number(1000.0 * interval_max_time) +
+                      "}\n");
+        reset_interval();
+    }
+
+private:
+    /* Wall clock time, so that lines can be matched with other logs */
+    static std::string timestamp()
+    {
+        auto now = std::chrono::system_clock::now().time_since_epoch();
+        char buf[32];
+
+        snprintf(buf, sizeof(buf), "%.3f",
+                 std::chrono::duration<double>(now).count());
+        return buf;
+    }
+
+    void begin_object(const std::string &type)
+    {
+        object_type = type;
+        fields.clear();
+    }
+
+    /* The timestamp is taken when the object is complete, e.g., at the end of a benchmark */
+    void end_object()
+    {
+        if (writer && !object_type.empty()) {
+            writer->write("{\"type\": \"" + object_type + "\", \"timestamp\": " +
+                          timestamp() + fields + "}\n");
+        }
+        object_type.clear();
+    }
+
+    void add_raw_field(const std::string &name, const std::string &value)
+    {
+        if (object_type.empty())
+            return;
+
+        fields += ", \"" + ResultsFile::json_escape(name) + "\": " + value;
+    }
+
+    void reset_interval()
+    {
+        interval_frames = 0;
+        interval_time = 0.0;
+        interval_max_time = 0.0;
+    }
+
+    std::unique_ptr<StreamWriter> writer;
+    unsigned int frame_interval;
+    std::string object_type;
+    std::string fields;
+    std::string benchmark_name;
+    uint64_t frames = 0;
+    unsigned int interval_frames = 0;
+    double interval_time = 0.0;
+    double interval_max_time = 0.0;
+};
+
+/*
+ * Passes the results to two results files.
+ */
+class TeeResultsFile : public ResultsFile
+{
+public:
+    TeeResultsFile(std::unique_ptr<ResultsFile> first, std::unique_ptr<ResultsFile> second) :
+        first{std::move(first)}, second{std::move(second)} {}
+
+    std::string type() override { return first->type() + " + " + second->type(); }
+    void begin() override { first->begin(); second->begin(); }
+    void end() override { first->end(); second->end(); }
+    void begin_info() override { first->begin_info(); second->begin_info(); }
+    void end_info() override { first->end_info(); second->end_info(); }
+    void begin_benchmark() override { first->begin_benchmark(); second->begin_benchmark(); }
+    void end_benchmark() override { first->end_benchmark(); second->end_benchmark(); }
+    void begin_summary() override { first->begin_summary(); second->begin_summary(); }
+    void end_summary() override { first->end_summary(); second->end_summary(); }
+
+    void add_field(const std::string &name, const std::string &value) override
+    {
+        first->add_field(name, value);
+        second->add_field(name, value);
+    }
+
+    void add_options(const std::map<std::string, std::string> &options) override
+    {
+        first->add_options(options);
+        second->add_options(options);
+    }
+
+    void add_array(const std::string &name, const std::vector<double> &values) override
+    {
+        first->add_array(name, values);
+        second->add_array(name, values);
+    }
+
+    void add_frame(double frame_time) override
+    {
+        first->add_frame(frame_time);
+        second->add_frame(frame_time);
+    }
+
+private:
+    std::unique_ptr<ResultsFile> first;
+    std::unique_ptr<ResultsFile> second;
+};
+
 std::string get_file_extension(const std::string &str)
 {
     auto i = str.rfind('.');
@@ -214,6 +644,10 @@ bool ResultsFile::init(const std::string &file)
     {
         ResultsFile::singleton = std::make_unique<XMLResultsFile>(std::move(fs));
     }
+    else if (ext == ".json")
+    {
+        ResultsFile::singleton = std::make_unique<JSONResultsFile>(std::move(fs));
+    }
     else
     {
         Log::error("Results file type %s is not supported\n", file.c_str());
@@ -226,7 +660,56 @@ bool ResultsFile::init(const std::string &file)
     return true;
 }
 
+bool ResultsFile::init_stream(const std::string &target, unsigned int frame_interval)
+{
+    if (target.empty())
+        return true;
+
+    /* Large enough to absorb a reader that stalls for a while */
+    std::unique_ptr<StreamWriter> writer{StreamWriter::open(target, 1 << 20)};
+    if (!writer)
+        return false;
+
+    ResultsFile::singleton = std::make_unique<TeeResultsFile>(
+        std::move(ResultsFile::singleton),
+        std::make_unique<StreamResultsFile>(std::move(writer), frame_interval));
+
+    Log::debug("Streaming results to %s\n", target.c_str());
+
+    return true;
+}
+
 ResultsFile& ResultsFile::get()
 {
     return *ResultsFile::singleton;
 }
+
+std::string ResultsFile::json_escape(const std::string &str)
+{
+    std::stringstream ss;
+
+    for (auto c : str)
+    {
+        switch (c)
+        {
+            case '"': ss << "\\\""; break;
+            case '\\': ss << "\\\\"; break;
+            case '\n': ss << "\\n"; break;
+            case '\t': ss << "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20)
+                {
+                    char buf[8];
+                    snprintf(buf, sizeof(buf), "\\u%04x", c);
+                    ss << buf;
+                }
+                else
+                {
+                    ss << c;
+                }
+                break;
+        }
+    }
+
+    return ss.str();
+}
@@ -24,7 +24,9 @@
 #define GLMARK2_RESULTS_FILE_
 
 #include <string>
+#include <map>
 #include <memory>
+#include <vector>
 
 class ResultsFile {
 public:
@@ -32,6 +34,20 @@ public:
     static ResultsFile& get();
     static bool init(const std::string &file);
 
+    /*
+     * Additionally streams the results live, as one JSON object per line,
+     * to a socket, pipe or file descriptor (see StreamWriter::open()).
+     * If frame_interval is not 0, a line is also streamed every
+     * frame_interval frames.
+     */
+    static bool init_stream(const std::string &target, unsigned int frame_interval);
+
+    /*
+     * Escapes a string for use in a JSON string literal, without adding
+     * the surrounding quotes. Shared by all the JSON writers.
+     */
+    static std::string json_escape(const std::string &str);
+
     virtual std::string type() = 0;
     virtual void begin() = 0;
     virtual void end() = 0;
@@ -39,8 +55,30 @@ public:
     virtual void end_info() = 0;
     virtual void begin_benchmark() = 0;
     virtual void end_benchmark() = 0;
+    virtual void begin_summary() = 0;
+    virtual void end_summary() = 0;
     virtual void add_field(const std::string &name, const std::string &value) = 0;
 
+    /*
+     * Structured fields. Formats that can only hold plain fields ignore
+     * them (the scene options are already part of the benchmark name).
+     */
+    virtual void add_options(const std::map<std::string, std::string> &options)
+    {
+        static_cast<void>(options);
+    }
+    virtual void add_array(const std::string &name, const std::vector<double> &values)
+    {
+        static_cast<void>(name);
+        static_cast<void>(values);
+    }
+
+    /* Called for every measured frame (not warm-up frames), with its duration in seconds */
+    virtual void add_frame(double frame_time)
+    {
+        static_cast<void>(frame_time);
+    }
+
 protected:
     ResultsFile() = default;
     static std::unique_ptr<ResultsFile> singleton;
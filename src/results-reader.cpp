@@ -0,0 +1,320 @@
+/*
+ * Copyright © 2026 Collabora Limited
+ *
+ * This file is part of the glmark2 OpenGL (ES) 2.0 benchmark.
+ *
+ * glmark2 is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * glmark2 is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * glmark2.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "results-reader.h"
+#include "log.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <stdexcept>
+
+namespace
+{
+
+/**
+ * A minimal JSON parser, reading from a stream.
+ *
+ * Only the parts of a results file that are needed are turned into
+ * values, everything else is skipped while parsing.
+ */
+class JSONParser
+{
+public:
+    JSONParser(std::istream &is) : is_(is), line_(1) {}
+
+    void parse(const std::function<void(const BenchmarkResult &)> &callback)
+    {
+        expect('{');
+        if (consume('}'))
+            return;
+
+        do {
+            std::string key = parse_string_value();
+            expect(':');
+
+            if (key == "benchmarks") {
+                expect('[');
+                if (!consume(']')) {
+                    do {
+                        callback(parse_benchmark());
+                    } while (consume(','));
+                    expect(']');
+                }
+            }
+            else {
+                skip_value();
+            }
+        } while (consume(','));
+
+        expect('}');
+    }
+
+private:
+    BenchmarkResult parse_benchmark()
+    {
+        BenchmarkResult result;
+
+        expect('{');
+        if (consume('}'))
+            return result;
+
+        do {
+            std::string key = parse_string_value();
+            expect(':');
+
+            char c = peek();
+            if (c == '"') {
+                std::string value = parse_string_value();
+                if (key == "name")
+                    result.name = value;
+                else if (key == "status")
+                    result.status = value;
+            }
+            else if (c == '-' || (c >= '0' && c <= '9')) {
+                result.fields[key] = parse_number();
+            }
+            else if (c == '[' && key == "frame_times") {
+                expect('[');
+                if (!consume(']')) {
+                    do {
+                        result.frame_times.push_back(parse_number());
+                    } while (consume(','));
+                    expect(']');
+                }
+            }
+            else {
+                skip_value();
+            }
+        } while (consume(','));
+
+        expect('}');
+
+        return result;
+    }
+
+    void skip_value()
+    {
+        char c = peek();
+
+        if (c == '{' || c == '[') {
+            char end = c == '{' ? '}' : ']';
+            get();
+            if (consume(end))
+                return;
+            do {
+                if (c == '{') {
+                    parse_string_value();
+                    expect(':');
+                }
+                skip_value();
+            } while (consume(','));
+            expect(end);
+        }
+        else if (c == '"') {
+            parse_string_value();
+        }
+        else if (c == '-' || (c >= '0' && c <= '9')) {
+            parse_number();
+        }
+        else {
+            std::string literal;
+            while (is_.peek() >= 'a' && is_.peek() <= 'z')
+                literal += static_cast<char>(is_.get());
+            if (literal != "true" && literal != "false" && literal != "null")
+                error("invalid value");
+        }
+    }
+
+    std::string parse_string_value()
+    {
+        std::string str;
+
+        expect('"');
+
+        while (true) {
+            int c = is_.get();
+            if (c == EOF)
+                error("unterminated string");
+            if (c == '"')
+                break;
+            if (c != '\\') {
+                str += static_cast<char>(c);
+                continue;
+            }
+
+            c = is_.get();
+            switch (c) {
+                case 'b': str += '\b'; break;
+                case 'f': str += '\f'; break;
+                case 'n': str += '\n'; break;
+                case 'r': str += '\r'; break;
+                case 't': str += '\t'; break;
+                case 'u': append_utf8(str, parse_hex4()); break;
+                case '"': case '\\': case '/': str += static_cast<char>(c); break;
+                default: error("invalid escape sequence");
+            }
+        }
+
+        return str;
+    }
+
+    double parse_number()
+    {
+        std::string str;
+
+        skip_whitespace();
+        while (true) {
+            int c = is_.peek();
+            if ((c >= '0' && c <= '9') || c == '-' || c == '+' ||
+                c == '.' || c == 'e' || c == 'E')
+            {
+                str += static_cast<char>(is_.get());
+            }
+            else {
+                break;
+            }
+        }
+
+        char *end;
+        double d = strtod(str.c_str(), &end);
+        if (str.empty() || *end != '\0')
+            error("invalid number");
+
+        return d;
+    }
+
+    unsigned int parse_hex4()
+    {
+        unsigned int value = 0;
+
+        for (int i = 0; i < 4; i++) {
+            int c = is_.get();
+            value <<= 4;
+            if (c >= '0' && c <= '9')
+                value |= c - '0';
+            else if (c >= 'a' && c <= 'f')
+                value |= c - 'a' + 10;
+            else if (c >= 'A' && c <= 'F')
+                value |= c - 'A' + 10;
+            else
+                error("invalid unicode escape");
+        }
+
+        return value;
+    }
+
+    static void append_utf8(std::string &str, unsigned int cp)
+    {
+        if (cp < 0x80) {
+            str += static_cast<char>(cp);
+        }
+        else if (cp < 0x800) {
+            str += static_cast<char>(0xc0 | (cp >> 6));
+            str += static_cast<char>(0x80 | (cp & 0x3f));
+        }
+        else {
+            str += static_cast<char>(0xe0 | (cp >> 12));
+            str += static_cast<char>(0x80 | ((cp >> 6) & 0x3f));
+            str += static_cast<char>(0x80 | (cp & 0x3f));
+        }
+    }
+
+    void skip_whitespace()
+    {
+        while (true) {
+            int c = is_.peek();
+            if (c == '\n')
+                line_++;
+            else if (c != ' ' && c != '\t' && c != '\r')
+                break;
+            is_.get();
+        }
+    }
+
+    char peek()
+    {
+        skip_whitespace();
+        return static_cast<char>(is_.peek());
+    }
+
+    char get()
+    {
+        skip_whitespace();
+        return static_cast<char>(is_.get());
+    }
+
+    bool consume(char c)
+    {
+        if (peek() != c)
+            return false;
+        is_.get();
+        return true;
+    }
+
+    void expect(char c)
+    {
+        if (!consume(c))
+            error(std::string("expected '") + c + "'");
+    }
+
+    [[noreturn]] void error(const std::string &msg)
+    {
+        throw std::runtime_error{"line " + std::to_string(line_) + ": " + msg};
+    }
+
+    std::istream &is_;
+    unsigned int line_;
+};
+
+}
+
+double
+BenchmarkResult::average_frame_time() const
+{
+    auto iter = fields.find("frame_time");
+    if (iter != fields.end())
+        return iter->second;
+
+    iter = fields.find("fps");
+    if (iter != fields.end() && iter->second > 0.0)
+        return 1000.0 / iter->second;
+
+    return 0.0;
+}
+
+bool
+ResultsReader::read(const std::string &file,
+                    const std::function<void(const BenchmarkResult &)> &callback)
+{
+    std::ifstream ifs(file);
+
+    if (!ifs) {
+        Log::error("Failed to open results file %s\n", file.c_str());
+        return false;
+    }
+
+    try {
+        JSONParser(ifs).parse(callback);
+    }
+    catch (const std::runtime_error &e) {
+        Log::error("Failed to parse results file %s: %s\n", file.c_str(), e.what());
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,69 @@
+/*
+ * Copyright © 2026 Collabora Limited
+ *
+ * This file is part of the glmark2 OpenGL (ES) 2.0 benchmark.
+ *
+ * glmark2 is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * glmark2 is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * glmark2.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef GLMARK2_RESULTS_READER_H_
+#define GLMARK2_RESULTS_READER_H_
+
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+/**
+ * A benchmark entry read from a results file.
+ */
+struct BenchmarkResult {
+    /** The benchmark name, as returned by Scene::info_string() */
+    std::string name;
+    std::string status;
+    /** The numeric fields of the entry (times are in ms) */
+    std::map<std::string, double> fields;
+    /** The time (in ms) of each frame, if saved with --results-frames */
+    std::vector<double> frame_times;
+
+    /**
+     * Gets the average frame time (in ms) of the benchmark.
+     *
+     * @return the average frame time, or 0.0 if it isn't available
+     */
+    double average_frame_time() const;
+};
+
+/**
+ * Reads JSON results files written by glmark2.
+ */
+class ResultsReader
+{
+public:
+    /**
+     * Reads the benchmark entries of a JSON results file.
+     *
+     * The file is parsed while it is read and each entry is passed to
+     * the callback as soon as it is complete, so memory use doesn't
+     * depend on the number of entries in the file.
+     *
+     * @param file the file to read
+     * @param callback the function to call for each entry
+     *
+     * @return whether the file was read successfully
+     */
+    static bool read(const std::string &file,
+                     const std::function<void(const BenchmarkResult &)> &callback);
+};
+
+#endif /* GLMARK2_RESULTS_READER_H_ */
@@ -112,7 +112,7 @@ public:
      */
     void update(double elapsed)
     {
-        std::vector<std::vector<float> >& vertices(mesh_.vertices());
+        Mesh::VertexView vertices(mesh_.vertices());
 
         /* Figure out which length index ranges need update */
         std::vector<std::pair<size_t, size_t> > ranges;
@@ -59,6 +59,32 @@ SceneBuild::SceneBuild(Canvas &pCanvas) :
                                            "false,true");
     options_["model"] = Scene::Option("model", "horse", "Which model to use",
                                       optionValues);
+    options_["indexed"] = Scene::Option("indexed", "false",
+                                        "Whether to draw the model with an index buffer, sharing identical vertices",
+                                        "false,true");
+    options_["vertex-cache-opt"] = Scene::Option("vertex-cache-opt", "false",
+                                                 "Whether to reorder the indexed triangles for the post-transform vertex cache",
+                                                 "false,true");
+    options_["vertex-format"] = Scene::Option("vertex-format", "float",
+                                              "How to store the vertex attributes",
+                                              "float,half,packed");
+    options_["use-vao"] = Scene::Option("use-vao", "false",
+                                        "Whether to record the VBO setup in vertex array objects",
+                                        "false,true");
+}
+
+bool
+SceneBuild::supported(bool show_errors)
+{
+    if (options_["use-vbo"].value == "true" && options_["use-vao"].value == "true" &&
+        !GLExtensions::GenVertexArrays)
+    {
+        if (show_errors)
+            Log::error("Vertex array objects are not supported\n");
+        return false;
+    }
+
+    return true;
 }
 
 SceneBuild::~SceneBuild()
@@ -145,7 +171,10 @@ SceneBuild::setup()
     attribs.push_back(std::pair<Model::AttribType, int>(Model::AttribTypePosition, 3));
     attribs.push_back(std::pair<Model::AttribType, int>(Model::AttribTypeNormal, 3));
 
-    model.convert_to_mesh(mesh_, attribs);
+    model.convert_to_mesh(mesh_, attribs, options_["indexed"].value == "true",
+                          options_["vertex-format"].value);
+    if (options_["vertex-cache-opt"].value == "true")
+        mesh_.optimize_vertex_cache();
 
     std::vector<GLint> attrib_locations;
     attrib_locations.push_back(program_["position"].location());
@@ -157,6 +186,7 @@ SceneBuild::setup()
 
     mesh_.vbo_update_method(Mesh::VBOUpdateMethodMap);
     mesh_.interleave(interleave);
+    mesh_.use_vao(options_["use-vao"].value == "true");
 
     if (useVbo_)
         mesh_.build_vbo();
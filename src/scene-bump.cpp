@@ -38,12 +38,36 @@ SceneBump::SceneBump(Canvas &pCanvas) :
     options_["bump-render"] = Scene::Option("bump-render", "off",
                                             "How to render bumps",
                                             "off,normals,normals-tangent,height,high-poly");
+    options_["indexed"] = Scene::Option("indexed", "false",
+                                        "Whether to draw the model with an index buffer, sharing identical vertices",
+                                        "false,true");
+    options_["vertex-cache-opt"] = Scene::Option("vertex-cache-opt", "false",
+                                                 "Whether to reorder the indexed triangles for the post-transform vertex cache",
+                                                 "false,true");
+    options_["vertex-format"] = Scene::Option("vertex-format", "float",
+                                              "How to store the vertex attributes",
+                                              "float,half,packed");
 }
 
 SceneBump::~SceneBump()
 {
 }
 
+void
+SceneBump::assets(const std::map<std::string, std::string> &options, Assets &assets)
+{
+    const std::string bump_render(option_value(options, "bump-render"));
+
+    assets.models.push_back(bump_render == "high-poly" ? "asteroid-high" : "asteroid-low");
+
+    if (bump_render == "normals")
+        assets.textures.push_back("asteroid-normal-map");
+    else if (bump_render == "normals-tangent")
+        assets.textures.push_back("asteroid-normal-map-tangent");
+    else if (bump_render == "height")
+        assets.textures.push_back("asteroid-height-map");
+}
+
 bool
 SceneBump::load()
 {
@@ -87,7 +111,8 @@ SceneBump::setup_model_plain(const std::string &type)
     attribs.push_back(std::pair<Model::AttribType, int>(Model::AttribTypePosition, 3));
     attribs.push_back(std::pair<Model::AttribType, int>(Model::AttribTypeNormal, 3));
 
-    model.convert_to_mesh(mesh_, attribs);
+    model.convert_to_mesh(mesh_, attribs, options_["indexed"].value == "true",
+                          options_["vertex-format"].value);
 
     /* Load shaders */
     ShaderSource vtx_source(vtx_shader_filename);
@@ -136,7 +161,8 @@ SceneBump::setup_model_normals()
     attribs.push_back(std::pair<Model::AttribType, int>(Model::AttribTypePosition, 3));
     attribs.push_back(std::pair<Model::AttribType, int>(Model::AttribTypeTexcoord, 2));
 
-    model.convert_to_mesh(mesh_, attribs);
+    model.convert_to_mesh(mesh_, attribs, options_["indexed"].value == "true",
+                          options_["vertex-format"].value);
 
     /* Load shaders */
     ShaderSource vtx_source(vtx_shader_filename);
@@ -192,7 +218,8 @@ SceneBump::setup_model_normals_tangent()
     attribs.push_back(std::pair<Model::AttribType, int>(Model::AttribTypeTexcoord, 2));
     attribs.push_back(std::pair<Model::AttribType, int>(Model::AttribTypeTangent, 3));
 
-    model.convert_to_mesh(mesh_, attribs);
+    model.convert_to_mesh(mesh_, attribs, options_["indexed"].value == "true",
+                          options_["vertex-format"].value);
 
     /* Load shaders */
     ShaderSource vtx_source(vtx_shader_filename);
@@ -250,7 +277,8 @@ SceneBump::setup_model_height()
     attribs.push_back(std::pair<Model::AttribType, int>(Model::AttribTypeTexcoord, 2));
     attribs.push_back(std::pair<Model::AttribType, int>(Model::AttribTypeTangent, 3));
 
-    model.convert_to_mesh(mesh_, attribs);
+    model.convert_to_mesh(mesh_, attribs, options_["indexed"].value == "true",
+                          options_["vertex-format"].value);
 
     /* Load shaders */
     ShaderSource vtx_source(vtx_shader_filename);
@@ -305,6 +333,9 @@ SceneBump::setup()
     if (!setup_succeeded)
         return false;
 
+    if (options_["vertex-cache-opt"].value == "true")
+        mesh_.optimize_vertex_cache();
+
     mesh_.build_vbo();
 
     program_.start();
@@ -54,8 +54,8 @@ SceneConditionals::~SceneConditionals()
 {
 }
 
-static std::string
-get_vertex_shader_source(int steps, bool conditionals)
+std::string
+SceneConditionals::get_vertex_shader_source(int steps, bool conditionals)
 {
     ShaderSource source(Options::data_path + vtx_file);
     ShaderSource source_main;
@@ -72,8 +72,8 @@ get_vertex_shader_source(int steps, bool conditionals)
     return source.str();
 }
 
-static std::string
-get_fragment_shader_source(int steps, bool conditionals)
+std::string
+SceneConditionals::get_fragment_shader_source(int steps, bool conditionals)
 {
     ShaderSource source(Options::data_path + frg_file);
     ShaderSource source_main;
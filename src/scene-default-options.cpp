@@ -51,6 +51,13 @@ SceneDefaultOptions::setup()
         }
     }
 
+    /*
+     * The defaults now live in the scenes themselves. Don't apply them again
+     * the next time an option-setting benchmark is set up, since that may be
+     * in a later pass over the benchmarks, after the defaults were restored.
+     */
+    defaultOptions_.clear();
+
     return true;
 }
 
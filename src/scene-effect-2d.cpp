@@ -50,6 +50,12 @@ SceneEffect2D::~SceneEffect2D()
 {
 }
 
+void
+SceneEffect2D::assets(const std::map<std::string, std::string> &, Assets &assets)
+{
+    assets.textures.push_back("effect-2d");
+}
+
 /*
  * Calculates the offset of the coefficient with index i
  * from the center of the kernel matrix. Note that we are
@@ -59,8 +59,9 @@ SceneFunction::~SceneFunction()
 {
 }
 
-static std::string
-get_vertex_shader_source(int steps, bool function, std::string &complexity)
+std::string
+SceneFunction::get_vertex_shader_source(int steps, bool function,
+                                        const std::string &complexity)
 {
     ShaderSource source(Options::data_path + vtx_file);
     ShaderSource source_main;
@@ -88,8 +89,9 @@ get_vertex_shader_source(int steps, bool function, std::string &complexity)
     return source.str();
 }
 
-static std::string
-get_fragment_shader_source(int steps, bool function, std::string &complexity)
+std::string
+SceneFunction::get_fragment_shader_source(int steps, bool function,
+                                          const std::string &complexity)
 {
     ShaderSource source(Options::data_path + frg_file);
     ShaderSource source_main;
@@ -31,6 +31,7 @@
 #include "util.h"
 #include "texture.h"
 #include "shader-source.h"
+#include "mesh-cache.h"
 
 SceneJellyfish::SceneJellyfish(Canvas& canvas) :
     Scene(canvas, "jellyfish"), priv_(0)
@@ -43,6 +44,18 @@ SceneJellyfish::~SceneJellyfish()
     delete priv_;
 }
 
+void
+SceneJellyfish::assets(const std::map<std::string, std::string> &, Assets &assets)
+{
+    assets.textures.push_back("jellyfish256");
+    for (unsigned int i = 1; i < 33; i++)
+    {
+        std::stringstream ss;
+        ss << "jellyfish-caustics-" << std::setw(2) << std::setfill('0') << i;
+        assets.textures.push_back(ss.str());
+    }
+}
+
 bool
 SceneJellyfish::setup()
 {
@@ -253,6 +266,9 @@ JellyfishPrivate::load_obj(const std::string &filename)
 {
     Log::debug("Loading model from file '%s'\n", filename.c_str());
 
+    if (MeshCache::enabled() && load_cached(filename))
+        return true;
+
     const std::unique_ptr<std::istream> input_file_ptr(Util::get_resource(filename));
     std::istream& inputFile(*input_file_ptr);
     if (!inputFile)
@@ -318,9 +334,96 @@ JellyfishPrivate::load_obj(const std::string &filename)
 
     Log::debug("Object populated with %u vertices %u normals %u colors %u texcoords and %u indices.\n",
         positions_.size(), normals_.size(), colors_.size(), texcoords_.size(), indices_.size());
+
+    if (MeshCache::enabled())
+        store_cached(filename);
+
     return true;
 }
 
+//
+// The model is cached as the position, normal, color and texcoord streams,
+// as floats, followed by the indices.
+//
+bool
+JellyfishPrivate::load_cached(const std::string& filename)
+{
+    std::unique_ptr<MeshCache::Entry> entry(MeshCache::load(filename));
+    if (!entry || entry->size() != 5)
+    {
+        return false;
+    }
+
+    // Check the whole entry before using it, since the source is parsed
+    // into the same vectors if the cache can't be used.
+    const float* data[4];
+    size_t nvertices = 0;
+
+    for (unsigned int i = 0; i < 4; i++)
+    {
+        size_t count = 0;
+        data[i] = entry->stream<float>(i, count);
+        if (!data[i] || count % 3 != 0 || (i > 0 && count / 3 != nvertices))
+        {
+            return false;
+        }
+        nvertices = count / 3;
+    }
+
+    size_t nindices = 0;
+    const unsigned short* indices = entry->stream<unsigned short>(4, nindices);
+    if (!indices)
+    {
+        return false;
+    }
+
+    for (size_t i = 0; i < nindices; i++)
+    {
+        if (indices[i] >= nvertices)
+        {
+            return false;
+        }
+    }
+
+    vector<vec3>* attribs[4] = {&positions_, &normals_, &colors_, &texcoords_};
+
+    for (unsigned int i = 0; i < 4; i++)
+    {
+        attribs[i]->resize(nvertices);
+        for (size_t v = 0; v < nvertices; v++)
+        {
+            (*attribs[i])[v] = vec3(data[i][3 * v], data[i][3 * v + 1], data[i][3 * v + 2]);
+        }
+    }
+
+    indices_.assign(indices, indices + nindices);
+
+    return true;
+}
+
+void
+JellyfishPrivate::store_cached(const std::string& filename)
+{
+    const vector<vec3>* attribs[4] = {&positions_, &normals_, &colors_, &texcoords_};
+    vector<float> data[4];
+    vector<MeshCache::Stream> streams;
+
+    for (unsigned int i = 0; i < 4; i++)
+    {
+        for (vector<vec3>::const_iterator vIt = attribs[i]->begin();
+             vIt != attribs[i]->end();
+             vIt++)
+        {
+            data[i].insert(data[i].end(), {vIt->x(), vIt->y(), vIt->z()});
+        }
+        streams.push_back(MeshCache::Stream(data[i].data(), data[i].size() * sizeof(float)));
+    }
+
+    streams.push_back(MeshCache::Stream(indices_.data(), indices_.size() * sizeof(unsigned short)));
+
+    MeshCache::store(filename, streams);
+}
+
 JellyfishPrivate::JellyfishPrivate() :
     positionLocation_(0),
     normalLocation_(0),
@@ -56,6 +56,8 @@ public:
 class JellyfishPrivate
 {
     bool load_obj(const std::string& filename);
+    bool load_cached(const std::string& filename);
+    void store_cached(const std::string& filename);
 
     // For the background gradient.
     GradientRenderer gradient_;
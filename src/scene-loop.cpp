@@ -60,8 +60,8 @@ SceneLoop::~SceneLoop()
 {
 }
 
-static std::string
-get_fragment_shader_source(int steps, bool loop, bool uniform)
+std::string
+SceneLoop::get_fragment_shader_source(int steps, bool loop, bool uniform)
 {
     ShaderSource source(Options::data_path + frg_file);
     ShaderSource source_main;
@@ -85,8 +85,8 @@ get_fragment_shader_source(int steps, bool loop, bool uniform)
     return source.str();
 }
 
-static std::string
-get_vertex_shader_source(int steps, bool loop, bool uniform)
+std::string
+SceneLoop::get_vertex_shader_source(int steps, bool loop, bool uniform)
 {
     ShaderSource source(Options::data_path + vtx_file);
     ShaderSource source_main;
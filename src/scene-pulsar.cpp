@@ -59,6 +59,13 @@ ScenePulsar::~ScenePulsar()
 {
 }
 
+void
+ScenePulsar::assets(const std::map<std::string, std::string> &options, Assets &assets)
+{
+    if (option_value(options, "texture") == "true")
+        assets.textures.push_back("crate-base");
+}
+
 bool
 ScenePulsar::load()
 {
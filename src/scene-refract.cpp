@@ -86,6 +86,18 @@ SceneRefract::SceneRefract(Canvas& canvas) :
     options_["interleave"] = Scene::Option("interleave", "false",
                                            "Whether to interleave vertex attribute data",
                                            "false,true");
+    options_["indexed"] = Scene::Option("indexed", "false",
+                                        "Whether to draw the model with an index buffer, sharing identical vertices",
+                                        "false,true");
+    options_["vertex-cache-opt"] = Scene::Option("vertex-cache-opt", "false",
+                                                 "Whether to reorder the indexed triangles for the post-transform vertex cache",
+                                                 "false,true");
+    options_["vertex-format"] = Scene::Option("vertex-format", "float",
+                                              "How to store the vertex attributes",
+                                              "float,half,packed");
+    options_["use-vao"] = Scene::Option("use-vao", "false",
+                                        "Whether to record the VBO setup in vertex array objects",
+                                        "false,true");
 }
 
 bool
@@ -111,6 +123,14 @@ SceneRefract::supported(bool show_errors)
         ret = false;
     }
 
+    if (options_["use-vbo"].value == "true" && options_["use-vao"].value == "true" &&
+        !GLExtensions::GenVertexArrays)
+    {
+        if (show_errors)
+            Log::error("Vertex array objects are not supported\n");
+        ret = false;
+    }
+
     return ret;
 }
 
@@ -329,12 +349,16 @@ RefractPrivate::setup(map<string, Scene::Option>& options)
     vector<std::pair<Model::AttribType, int> > attribs;
     attribs.push_back(std::pair<Model::AttribType, int>(Model::AttribTypePosition, 3));
     attribs.push_back(std::pair<Model::AttribType, int>(Model::AttribTypeNormal, 3));
-    model.convert_to_mesh(mesh_, attribs);
+    model.convert_to_mesh(mesh_, attribs, options["indexed"].value == "true",
+                          options["vertex-format"].value);
+    if (options["vertex-cache-opt"].value == "true")
+        mesh_.optimize_vertex_cache();
 
     useVbo_ = (options["use-vbo"].value == "true");
     bool interleave = (options["interleave"].value == "true");
     mesh_.vbo_update_method(Mesh::VBOUpdateMethodMap);
     mesh_.interleave(interleave);
+    mesh_.use_vao(options["use-vao"].value == "true");
 
     if (useVbo_) {
         mesh_.build_vbo();
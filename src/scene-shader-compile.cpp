@@ -0,0 +1,427 @@
+/*
+ * Copyright © 2026 Collabora Limited
+ *
+ * This file is part of the glmark2 OpenGL (ES) 2.0 benchmark.
+ *
+ * glmark2 is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * glmark2 is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * glmark2.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "scene.h"
+#include "gl-headers.h"
+#include "log.h"
+#include "util.h"
+
+#include <thread>
+
+/**
+ * A shader program being built.
+ */
+struct ShaderCompileJob {
+    GLuint vertex_shader = 0;
+    GLuint fragment_shader = 0;
+    GLuint program = 0;
+};
+
+struct SceneShaderCompilePrivate {
+    std::vector<std::string> generators;
+    unsigned int steps = 0;
+    unsigned int variants = 0;
+    unsigned int programs_per_frame = 0;
+    bool parallel = false;
+    bool threads_set = false;
+    bool warming_up = false;
+    /* Makes the sources of different runs differ, to defeat on-disk driver caches */
+    uint64_t run_salt = 0;
+    uint64_t next_variant = 0;
+    std::vector<ShaderCompileJob> jobs;
+
+    /* Totals of the current run */
+    uint64_t programs = 0;
+    double compile_time = 0.0;
+    double link_time = 0.0;
+
+    void reset_totals() { programs = 0; compile_time = 0.0; link_time = 0.0; }
+    std::string vertex_source(uint64_t variant);
+    std::string fragment_source(uint64_t variant);
+    void source_params(uint64_t variant, std::string &generator,
+                       unsigned int &steps, bool &flag);
+    bool build(std::vector<ShaderCompileJob> &jobs);
+    bool build_parallel(std::vector<ShaderCompileJob> &jobs);
+    void release(std::vector<ShaderCompileJob> &jobs);
+};
+
+/*
+ * Maps a variant number to the parameters of its shaders. Consecutive
+ * variants cycle through the generators first, then through the number of
+ * steps, then through the generator-specific flag, so any corpus size mixes
+ * generators and complexities.
+ */
+void
+SceneShaderCompilePrivate::source_params(uint64_t variant, std::string &generator,
+                                         unsigned int &variant_steps, bool &flag)
+{
+    uint64_t index = variant % variants;
+
+    generator = generators[index % generators.size()];
+    index /= generators.size();
+    variant_steps = 1 + index % steps;
+    index /= steps;
+    flag = index % 2 == 0;
+}
+
+/*
+ * Adds a declaration that is unique to the variant, so that every compiled
+ * shader has a different source. The sources don't have a #version line, so
+ * the declaration can come first, and int has a default precision in both
+ * vertex and fragment shaders.
+ */
+static std::string
+add_variant_tag(const std::string &source, uint64_t tag)
+{
+    return "const int ShaderCompileVariant = " + Util::toString(tag % 2147483647) +
+           ";\n" + source;
+}
+
+std::string
+SceneShaderCompilePrivate::vertex_source(uint64_t variant)
+{
+    std::string generator;
+    unsigned int variant_steps;
+    bool flag;
+    std::string source;
+
+    source_params(variant, generator, variant_steps, flag);
+
+    if (generator == "conditionals")
+        source = SceneConditionals::get_vertex_shader_source(variant_steps, flag);
+    else if (generator == "function")
+        source = SceneFunction::get_vertex_shader_source(variant_steps, flag, "medium");
+    else
+        source = SceneLoop::get_vertex_shader_source(variant_steps, true, !flag);
+
+    return add_variant_tag(source, run_salt + variant);
+}
+
+std::string
+SceneShaderCompilePrivate::fragment_source(uint64_t variant)
+{
+    std::string generator;
+    unsigned int variant_steps;
+    bool flag;
+    std::string source;
+
+    source_params(variant, generator, variant_steps, flag);
+
+    if (generator == "conditionals")
+        source = SceneConditionals::get_fragment_shader_source(variant_steps, flag);
+    else if (generator == "function")
+        source = SceneFunction::get_fragment_shader_source(variant_steps, flag, "medium");
+    else
+        source = SceneLoop::get_fragment_shader_source(variant_steps, true, !flag);
+
+    return add_variant_tag(source, run_salt + variant);
+}
+
+static GLuint
+create_shader(GLenum type, const std::string &source)
+{
+    GLuint shader = glCreateShader(type);
+    const GLchar *str = source.c_str();
+
+    glShaderSource(shader, 1, &str, NULL);
+    glCompileShader(shader);
+
+    return shader;
+}
+
+static bool
+check_shader(GLuint shader)
+{
+    GLint status = GL_FALSE;
+
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
+    if (status == GL_FALSE) {
+        GLint length = 0;
+        glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &length);
+        std::string log(length + 1, '\0');
+        glGetShaderInfoLog(shader, length + 1, NULL, &log[0]);
+        Log::error("Failed to compile shader: %s\n", log.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+static GLuint
+create_program(const ShaderCompileJob &job)
+{
+    GLuint program = glCreateProgram();
+
+    glAttachShader(program, job.vertex_shader);
+    glAttachShader(program, job.fragment_shader);
+    glLinkProgram(program);
+
+    return program;
+}
+
+static bool
+check_program(GLuint program)
+{
+    GLint status = GL_FALSE;
+
+    glGetProgramiv(program, GL_LINK_STATUS, &status);
+    if (status == GL_FALSE) {
+        GLint length = 0;
+        glGetProgramiv(program, GL_INFO_LOG_LENGTH, &length);
+        std::string log(length + 1, '\0');
+        glGetProgramInfoLog(program, length + 1, NULL, &log[0]);
+        Log::error("Failed to link program: %s\n", log.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+/*
+ * Builds the programs one after the other. Querying the status after each
+ * operation waits for it to complete, which splits the time between
+ * compiling and linking.
+ */
+bool
+SceneShaderCompilePrivate::build(std::vector<ShaderCompileJob> &build_jobs)
+{
+    for (auto &job : build_jobs) {
+        uint64_t variant = next_variant++;
+        std::string vtx_source(vertex_source(variant));
+        std::string frg_source(fragment_source(variant));
+
+        uint64_t compile_start = Util::get_timestamp_us();
+        job.vertex_shader = create_shader(GL_VERTEX_SHADER, vtx_source);
+        job.fragment_shader = create_shader(GL_FRAGMENT_SHADER, frg_source);
+        if (!check_shader(job.vertex_shader) || !check_shader(job.fragment_shader))
+            return false;
+
+        uint64_t link_start = Util::get_timestamp_us();
+        job.program = create_program(job);
+        if (!check_program(job.program))
+            return false;
+        uint64_t link_end = Util::get_timestamp_us();
+
+        compile_time += (link_start - compile_start) / 1000000.0;
+        link_time += (link_end - link_start) / 1000000.0;
+        programs++;
+    }
+
+    return true;
+}
+
+/*
+ * Submits all the shaders of the frame before waiting for any of them, then
+ * all the programs, so that the driver can build them on multiple threads
+ * (GL_KHR_parallel_shader_compile). The times are those of the whole batch.
+ */
+bool
+SceneShaderCompilePrivate::build_parallel(std::vector<ShaderCompileJob> &build_jobs)
+{
+    std::vector<std::string> vtx_sources;
+    std::vector<std::string> frg_sources;
+
+    for (size_t i = 0; i < build_jobs.size(); i++) {
+        uint64_t variant = next_variant++;
+        vtx_sources.push_back(vertex_source(variant));
+        frg_sources.push_back(fragment_source(variant));
+    }
+
+    uint64_t compile_start = Util::get_timestamp_us();
+
+    for (size_t i = 0; i < build_jobs.size(); i++) {
+        build_jobs[i].vertex_shader = create_shader(GL_VERTEX_SHADER, vtx_sources[i]);
+        build_jobs[i].fragment_shader = create_shader(GL_FRAGMENT_SHADER, frg_sources[i]);
+    }
+
+    for (auto &job : build_jobs) {
+        for (GLuint shader : {job.vertex_shader, job.fragment_shader}) {
+            GLint done = GL_FALSE;
+            while (glGetShaderiv(shader, GL_COMPLETION_STATUS_KHR, &done), done == GL_FALSE)
+                std::this_thread::yield();
+        }
+    }
+
+    uint64_t link_start = Util::get_timestamp_us();
+
+    for (auto &job : build_jobs)
+        job.program = create_program(job);
+
+    for (auto &job : build_jobs) {
+        GLint done = GL_FALSE;
+        while (glGetProgramiv(job.program, GL_COMPLETION_STATUS_KHR, &done), done == GL_FALSE)
+            std::this_thread::yield();
+    }
+
+    uint64_t link_end = Util::get_timestamp_us();
+
+    /* Only check for errors when everything is done, so checking doesn't serialize the builds */
+    for (auto &job : build_jobs) {
+        if (!check_shader(job.vertex_shader) || !check_shader(job.fragment_shader) ||
+            !check_program(job.program))
+        {
+            return false;
+        }
+    }
+
+    compile_time += (link_start - compile_start) / 1000000.0;
+    link_time += (link_end - link_start) / 1000000.0;
+    programs += build_jobs.size();
+
+    return true;
+}
+
+void
+SceneShaderCompilePrivate::release(std::vector<ShaderCompileJob> &release_jobs)
+{
+    for (auto &job : release_jobs) {
+        if (job.program)
+            glDeleteProgram(job.program);
+        if (job.vertex_shader)
+            glDeleteShader(job.vertex_shader);
+        if (job.fragment_shader)
+            glDeleteShader(job.fragment_shader);
+        job = ShaderCompileJob();
+    }
+}
+
+SceneShaderCompile::SceneShaderCompile(Canvas &pCanvas) :
+    Scene(pCanvas, "shader-compile")
+{
+    priv_ = new SceneShaderCompilePrivate();
+    options_["generator"] = Scene::Option("generator", "all",
+                                          "The generator of the shader variants",
+                                          "all,conditionals,function,loop");
+    options_["steps"] = Scene::Option("steps", "10",
+                                      "The largest number of computational steps in a shader variant");
+    options_["variants"] = Scene::Option("variants", "64",
+                                         "The number of different shader variants to cycle through");
+    options_["programs-per-frame"] = Scene::Option("programs-per-frame", "4",
+                                                   "The number of programs to build in each frame");
+    options_["parallel"] = Scene::Option("parallel", "false",
+                                         "Whether to let the driver build the programs of a frame in parallel"
+                                         " (requires GL_KHR_parallel_shader_compile)",
+                                         "false,true");
+    options_["compiler-threads"] = Scene::Option("compiler-threads", "",
+                                                 "The number of compiler threads for parallel builds"
+                                                 " (default: chosen by the driver)");
+}
+
+SceneShaderCompile::~SceneShaderCompile()
+{
+    delete priv_;
+}
+
+bool
+SceneShaderCompile::supported(bool show_errors)
+{
+    if (options_["parallel"].value == "true" && !GLExtensions::MaxShaderCompilerThreads) {
+        if (show_errors) {
+            Log::error("Requested parallel shader compilation but"
+                       " GL_KHR_parallel_shader_compile is not supported!\n");
+        }
+        return false;
+    }
+
+    return true;
+}
+
+bool
+SceneShaderCompile::setup()
+{
+    if (!Scene::setup())
+        return false;
+
+    const std::string &generator = options_["generator"].value;
+    priv_->generators.clear();
+    if (generator == "all")
+        priv_->generators = {"conditionals", "function", "loop"};
+    else
+        priv_->generators.push_back(generator);
+
+    priv_->steps = std::max(1u, Util::fromString<unsigned int>(options_["steps"].value));
+    priv_->variants = std::max(1u, Util::fromString<unsigned int>(options_["variants"].value));
+    priv_->programs_per_frame =
+        std::max(1u, Util::fromString<unsigned int>(options_["programs-per-frame"].value));
+    priv_->parallel = options_["parallel"].value == "true";
+    priv_->run_salt = Util::get_timestamp_us();
+    priv_->next_variant = 0;
+    priv_->jobs.assign(priv_->programs_per_frame, ShaderCompileJob());
+    priv_->reset_totals();
+
+    priv_->threads_set = priv_->parallel && !options_["compiler-threads"].value.empty();
+    if (priv_->threads_set) {
+        GLExtensions::MaxShaderCompilerThreads(
+            Util::fromString<unsigned int>(options_["compiler-threads"].value));
+    }
+
+    priv_->warming_up = true;
+
+    return true;
+}
+
+void
+SceneShaderCompile::teardown()
+{
+    priv_->release(priv_->jobs);
+
+    /* Restore the default number of compiler threads */
+    if (priv_->threads_set)
+        GLExtensions::MaxShaderCompilerThreads(0xFFFFFFFF);
+
+    Scene::teardown();
+}
+
+void
+SceneShaderCompile::draw()
+{
+    /* Only count the programs built after the warm-up */
+    if (priv_->warming_up && !warmingUp_)
+        priv_->reset_totals();
+    priv_->warming_up = warmingUp_;
+
+    bool ok = priv_->parallel ? priv_->build_parallel(priv_->jobs) :
+                                priv_->build(priv_->jobs);
+
+    priv_->release(priv_->jobs);
+
+    if (!ok)
+        running_ = false;
+}
+
+std::vector<Scene::ExtraResult>
+SceneShaderCompile::extra_results()
+{
+    std::vector<ExtraResult> results;
+    double build_time = priv_->compile_time + priv_->link_time;
+
+    if (priv_->programs == 0 || build_time <= 0.0)
+        return results;
+
+    /* In parallel mode, the times are shared by all the programs of a batch */
+    double shaders = 2.0 * priv_->programs;
+
+    results.push_back({"Programs/s", "programs_per_second",
+                       Util::toString(priv_->programs / build_time, 1), ""});
+    results.push_back({"CompileTime", "compile_time",
+                       Util::toString(1000.0 * priv_->compile_time / shaders, 3), "ms"});
+    results.push_back({"LinkTime", "link_time",
+                       Util::toString(1000.0 * priv_->link_time / priv_->programs, 3), "ms"});
+
+    return results;
+}
@@ -65,6 +65,15 @@ SceneShading::SceneShading(Canvas &pCanvas) :
             "The number of lights applied to the scene (phong only)");
     options_["model"] = Scene::Option("model", "cat", "Which model to use",
                                       optionValues);
+    options_["indexed"] = Scene::Option("indexed", "false",
+                                        "Whether to draw the model with an index buffer, sharing identical vertices",
+                                        "false,true");
+    options_["vertex-cache-opt"] = Scene::Option("vertex-cache-opt", "false",
+                                                 "Whether to reorder the indexed triangles for the post-transform vertex cache",
+                                                 "false,true");
+    options_["vertex-format"] = Scene::Option("vertex-format", "float",
+                                              "How to store the vertex attributes",
+                                              "float,half,packed");
 }
 
 SceneShading::~SceneShading()
@@ -230,7 +239,10 @@ SceneShading::setup()
     attribs.push_back(std::pair<Model::AttribType, int>(Model::AttribTypePosition, 3));
     attribs.push_back(std::pair<Model::AttribType, int>(Model::AttribTypeNormal, 3));
 
-    model.convert_to_mesh(mesh_, attribs);
+    model.convert_to_mesh(mesh_, attribs, options_["indexed"].value == "true",
+                          options_["vertex-format"].value);
+    if (options_["vertex-cache-opt"].value == "true")
+        mesh_.optimize_vertex_cache();
 
     mesh_.build_vbo();
 
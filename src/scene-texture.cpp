@@ -82,6 +82,15 @@ SceneTexture::SceneTexture(Canvas &pCanvas) :
     options_["texgen"] = Scene::Option("texgen", "false",
                                        "Whether to generate texcoords in the shader",
                                        "false,true");
+    options_["indexed"] = Scene::Option("indexed", "false",
+                                        "Whether to draw the model with an index buffer, sharing identical vertices",
+                                        "false,true");
+    options_["vertex-cache-opt"] = Scene::Option("vertex-cache-opt", "false",
+                                                 "Whether to reorder the indexed triangles for the post-transform vertex cache",
+                                                 "false,true");
+    options_["vertex-format"] = Scene::Option("vertex-format", "float",
+                                              "How to store the vertex attributes",
+                                              "float,half,packed");
 }
 
 SceneTexture::~SceneTexture()
@@ -214,7 +223,10 @@ SceneTexture::setup()
     if (!doTexGen) {
         attribs.push_back(std::pair<Model::AttribType, int>(Model::AttribTypeTexcoord, 2));
     }
-    model.convert_to_mesh(mesh_, attribs);
+    model.convert_to_mesh(mesh_, attribs, options_["indexed"].value == "true",
+                          options_["vertex-format"].value);
+    if (options_["vertex-cache-opt"].value == "true")
+        mesh_.optimize_vertex_cache();
     mesh_.build_vbo();
 
     // Calculate a projection matrix that is a good fit for the model
@@ -25,7 +25,11 @@
 #include "log.h"
 #include "shader-source.h"
 #include "options.h"
+#include "program-cache.h"
 #include "util.h"
+#include "trace.h"
+#include "texture.h"
+#include "model.h"
 #include <sstream>
 #include <algorithm>
 
@@ -44,12 +48,29 @@ name(nam), value(val), default_value(val), description(desc), set(false)
 
 Scene::Scene(Canvas &pCanvas, const string &name) :
     canvas_(pCanvas), name_(name),
-    currentFrame_(0), running_(0), duration_(0), nframes_(0)
+    currentFrame_(0), running_(0), loaded_(false), warmingUp_(false), converged_(false),
+    duration_(0), nframes_(0), warmupDuration_(0), warmupFrames_(0),
+    adaptive_(false), adaptiveTarget_(0), adaptiveMinDuration_(0)
 {
     options_["duration"] = Scene::Option("duration", "10.0",
                                          "The duration of each benchmark in seconds");
     options_["nframes"] = Scene::Option("nframes", "",
                                          "The number of frames to render");
+    options_["warmup-duration"] = Scene::Option("warmup-duration", "0.0",
+                                                "The minimum duration in seconds of the warm-up phase, "
+                                                "which is excluded from the results");
+    options_["warmup-frames"] = Scene::Option("warmup-frames", "0",
+                                              "The minimum number of frames to render in the warm-up phase, "
+                                              "which is excluded from the results");
+    options_["adaptive"] = Scene::Option("adaptive", "false",
+                                         "Stop the benchmark as soon as the mean frame time has converged "
+                                         "('duration' sets the maximum duration)",
+                                         "false,true");
+    options_["adaptive-target"] = Scene::Option("adaptive-target", "0.01",
+                                                "The relative half-width of the 95% confidence interval of the "
+                                                "mean frame time at which an adaptive benchmark stops");
+    options_["adaptive-min-duration"] = Scene::Option("adaptive-min-duration", "1.0",
+                                                      "The minimum duration in seconds of an adaptive benchmark");
     options_["vertex-precision"] = Scene::Option("vertex-precision",
                                                  "default,default,default,default",
                                                  "The precision values for the vertex shader (\"int,float,sampler2d,samplercube\")");
@@ -109,13 +130,45 @@ Scene::teardown()
 void
 Scene::update()
 {
-    realTime_.lastUpdate = Util::get_timestamp_us() / 1000000.0;
+    double now = Util::get_timestamp_us() / 1000000.0;
+
+    frameTimes_.push_back(now - realTime_.lastUpdate);
+    realTime_.lastUpdate = now;
+
+    gpuTimer_.next_frame();
 
     currentFrame_++;
 
+    if (warmingUp_) {
+        if (currentFrame_ >= warmupFrames_ &&
+            realTime_.elapsed() >= warmupDuration_)
+        {
+            end_warmup();
+        }
+        return;
+    }
+
+    frameTimeStats_.add(frameTimes_.back());
+
     if (realTime_.elapsed() >= duration_)
         running_ = false;
 
+    /*
+     * In adaptive mode, stop as soon as the mean frame time is known with
+     * the requested precision. Require a minimum number of frames so that
+     * the confidence interval estimate is meaningful.
+     */
+    static const unsigned int adaptive_min_frames = 30;
+
+    if (adaptive_ && running_ &&
+        currentFrame_ >= adaptive_min_frames &&
+        realTime_.elapsed() >= adaptiveMinDuration_ &&
+        frameTimeStats_.ci95_half_width() <= adaptiveTarget_ * frameTimeStats_.mean())
+    {
+        converged_ = true;
+        running_ = false;
+    }
+
     if (nframes_ > 0 && currentFrame_ >= nframes_)
         running_ = false;
 }
@@ -125,6 +178,33 @@ Scene::draw()
 {
 }
 
+const char *
+Scene::frame_phase_name(FramePhase phase)
+{
+    static const char *names[FramePhaseCount] = {
+        "clear", "draw", "update", "frame_end", "flip", "sync_wait"
+    };
+
+    return names[phase];
+}
+
+void
+Scene::add_frame_phase_times(const double *times)
+{
+    if (!(Options::results & Options::ResultsPhases))
+        return;
+
+    /*
+     * The phase times are recorded after the frame has been updated, so
+     * a frame count of 0 here means the frame that ended the warm-up.
+     */
+    if (warmingUp_ || currentFrame_ == 0)
+        return;
+
+    for (int i = 0; i < FramePhaseCount; i++)
+        phaseTimes_[i].push_back(times[i]);
+}
+
 string
 Scene::info_string(const string &title)
 {
@@ -157,6 +237,52 @@ Scene::stats()
                                        (nproc * realTime_.elapsed());
     stats.shader_compilation_time = shaderCompilationTime_;
 
+    std::vector<double> sorted(frameTimes_);
+    std::sort(sorted.begin(), sorted.end());
+
+    stats.min_frame_time = sorted.empty() ? 0.0 : sorted.front();
+    stats.median_frame_time = Statistics::percentile(sorted, 50.0);
+    stats.p90_frame_time = Statistics::percentile(sorted, 90.0);
+    stats.p95_frame_time = Statistics::percentile(sorted, 95.0);
+    stats.p99_frame_time = Statistics::percentile(sorted, 99.0);
+    stats.max_frame_time = sorted.empty() ? 0.0 : sorted.back();
+    stats.stddev_frame_time =
+        Statistics::stddev(sorted, Statistics::mean(sorted));
+    stats.average_gpu_time = Statistics::mean(gpuTimer_.frame_times());
+    stats.frame_time_ci95 = frameTimeStats_.ci95_half_width();
+    stats.run_time = realTime_.elapsed();
+    stats.converged = converged_;
+
+    stats.warmup_frames = warmupFrameTimes_.size();
+    stats.average_warmup_frame_time = Statistics::mean(warmupFrameTimes_);
+    stats.max_warmup_frame_time = warmupFrameTimes_.empty() ? 0.0 :
+        *std::max_element(warmupFrameTimes_.begin(), warmupFrameTimes_.end());
+
+    for (auto t : sorted)
+        stats.frame_time_histogram.add(t);
+
+    for (int i = 0; i < FramePhaseCount; i++) {
+        std::vector<double> sorted_phase(phaseTimes_[i]);
+        std::sort(sorted_phase.begin(), sorted_phase.end());
+
+        PhaseStats &phase = stats.phase_time[i];
+        phase.average = Statistics::mean(sorted_phase);
+        phase.median = Statistics::percentile(sorted_phase, 50.0);
+        phase.p90 = Statistics::percentile(sorted_phase, 90.0);
+        phase.p99 = Statistics::percentile(sorted_phase, 99.0);
+    }
+
+    for (int i = 0; i < PerfCounters::CounterCount; i++) {
+        PerfCounters::Counter counter = static_cast<PerfCounters::Counter>(i);
+        stats.perf_available[i] = perfCounters_.available(counter);
+        stats.perf_per_frame[i] = currentFrame_ > 0 ?
+            perfCounters_.value(counter) / currentFrame_ : 0.0;
+    }
+
+    stats.memory_baseline = memoryMonitor_.baseline();
+    stats.memory_peak = memoryMonitor_.peak();
+    stats.memory_final = memoryMonitor_.final();
+
     return stats;
 }
 
@@ -220,8 +346,15 @@ Scene::set_option_default(const string &opt, const string &val)
 bool
 Scene::prepare()
 {
+    TraceSpan span("prepare", "scene", name_);
+
     duration_ = Util::fromString<double>(options_["duration"].value);
     nframes_ = Util::fromString<unsigned>(options_["nframes"].value);
+    warmupDuration_ = Util::fromString<double>(options_["warmup-duration"].value);
+    warmupFrames_ = Util::fromString<unsigned>(options_["warmup-frames"].value);
+    adaptive_ = options_["adaptive"].value == "true";
+    adaptiveTarget_ = Util::fromString<double>(options_["adaptive-target"].value);
+    adaptiveMinDuration_ = Util::fromString<double>(options_["adaptive-min-duration"].value);
 
     ShaderSource::default_precision(
             ShaderSource::Precision(options_["vertex-precision"].value),
@@ -233,8 +366,27 @@ Scene::prepare()
             ShaderSource::ShaderTypeFragment
             );
 
+    /*
+     * Reserve room for the expected number of frame times up front, so that
+     * recording them doesn't cause reallocations while the scene is running.
+     */
+    size_t expected_frames = nframes_ > 0 ? nframes_ : duration_ * 2000;
+    frameTimes_.clear();
+    warmupFrameTimes_.clear();
+    frameTimeStats_.clear();
+    frameTimes_.reserve(std::min<size_t>(std::max<size_t>(expected_frames, 1024),
+                                         1 << 20));
+
+    for (auto &times : phaseTimes_) {
+        times.clear();
+        if (Options::results & Options::ResultsPhases)
+            times.reserve(frameTimes_.capacity());
+    }
+
     currentFrame_ = 0;
     running_ = false;
+    warmingUp_ = warmupDuration_ > 0.0 || warmupFrames_ > 0;
+    converged_ = false;
     realTime_.start = realTime_.lastUpdate = 0;
     userTime_.start = userTime_.lastUpdate = 0;
     systemTime_.start = systemTime_.lastUpdate = 0;
@@ -243,8 +395,24 @@ Scene::prepare()
     if (!supported(true))
         return false;
 
-    if (!load() || !setup())
-        return false;
+    if (Options::results & Options::ResultsMemory)
+        memoryMonitor_.start();
+
+    /* The resources may still be loaded from the previous run */
+    if (!loaded_) {
+        TraceSpan load_span("load", "scene", name_);
+        if (!load())
+            return false;
+        loaded_ = true;
+    }
+
+    {
+        TraceSpan setup_span("setup", "scene", name_);
+        if (!setup())
+            return false;
+    }
+
+    memoryMonitor_.update();
 
     running_ = true;
     update_elapsed_times();
@@ -253,15 +421,52 @@ Scene::prepare()
     systemTime_.start = systemTime_.lastUpdate;
     idleTime_.start = idleTime_.lastUpdate;
 
+    if ((Options::results & Options::ResultsGpu) &&
+        !gpuTimer_.start(frameTimes_.capacity()))
+    {
+        static bool warned = false;
+        if (!warned) {
+            Log::warning("Timer queries not supported, GPU times will not be reported\n");
+            warned = true;
+        }
+    }
+
+    if ((Options::results & Options::ResultsPerf) && !perfCounters_.start())
+    {
+        static bool warned = false;
+        if (!warned) {
+            Log::warning("Performance counters not available, perf results will not be reported\n");
+            warned = true;
+        }
+    }
+
     return true;
 }
 
 void
-Scene::finish()
+Scene::finish(bool keep_loaded)
 {
     update_elapsed_times();
-    teardown();
-    unload();
+    gpuTimer_.stop();
+    perfCounters_.stop();
+    memoryMonitor_.update();
+
+    {
+        TraceSpan span("finish", "scene", name_);
+        teardown();
+
+        /* A failed load may have left partially loaded resources behind */
+        if (!keep_loaded || !loaded_) {
+            unload();
+            loaded_ = false;
+
+            /* The cached assets are only useful for runs of the same scene */
+            Texture::clear_cache();
+            Model::clear_cache();
+        }
+    }
+
+    memoryMonitor_.stop();
 }
 
 string
@@ -295,6 +500,33 @@ Scene::construct_title(const string &title)
 
 }
 
+/*
+ * Gets the value an option will have in a run with the specified options,
+ * without changing the current value.
+ */
+string
+Scene::option_value(const map<string, string> &options, const string &name)
+{
+    map<string, string>::const_iterator iter = options.find(name);
+    if (iter != options.end())
+        return iter->second;
+
+    map<string, Option>::const_iterator opt_iter = options_.find(name);
+    if (opt_iter != options_.end())
+        return opt_iter->second.default_value;
+
+    return "";
+}
+
+void
+Scene::assets(const map<string, string> &options, Assets &assets)
+{
+    if (options_.find("model") != options_.end())
+        assets.models.push_back(option_value(options, "model"));
+    if (options_.find("texture") != options_.end())
+        assets.textures.push_back(option_value(options, "texture"));
+}
+
 bool
 Scene::load_shaders_from_strings(Program &program,
                                  const std::string &vtx_shader,
@@ -302,10 +534,19 @@ Scene::load_shaders_from_strings(Program &program,
                                  const std::string &vtx_shader_filename,
                                  const std::string &frg_shader_filename)
 {
+    TraceSpan span("compile_shaders", "shader",
+                   vtx_shader_filename + " " + frg_shader_filename);
     double shaderStartTime = Util::get_timestamp_us() / 1000000.0;
 
     program.init();
 
+    if (ProgramCache::enabled() && program.valid() &&
+        ProgramCache::load(program, vtx_shader, frg_shader))
+    {
+        shaderCompilationTime_ += Util::get_timestamp_us() / 1000000.0 - shaderStartTime;
+        return true;
+    }
+
     Log::debug("Loading vertex shader from file %s:\n%s",
                vtx_shader_filename.c_str(), vtx_shader.c_str());
 
@@ -340,11 +581,43 @@ Scene::load_shaders_from_strings(Program &program,
         return false;
     }
 
+    /* Storing the binary in the cache is not part of building the program */
     shaderCompilationTime_ += Util::get_timestamp_us() / 1000000.0 - shaderStartTime;
 
+    if (ProgramCache::enabled())
+        ProgramCache::store(program, vtx_shader, frg_shader);
+
     return true;
 }
 
+void
+Scene::end_warmup()
+{
+    bool gpu_timing = gpuTimer_.active();
+
+    warmupFrameTimes_.assign(frameTimes_.begin(), frameTimes_.end());
+    frameTimes_.clear();
+    frameTimeStats_.clear();
+    for (auto &times : phaseTimes_)
+        times.clear();
+    currentFrame_ = 0;
+    warmingUp_ = false;
+
+    /* Wait for the warm-up GPU work before restarting the timers */
+    gpuTimer_.stop();
+
+    update_elapsed_times();
+    realTime_.start = realTime_.lastUpdate;
+    userTime_.start = userTime_.lastUpdate;
+    systemTime_.start = systemTime_.lastUpdate;
+    idleTime_.start = idleTime_.lastUpdate;
+
+    perfCounters_.restart();
+
+    if (gpu_timing)
+        gpuTimer_.start(frameTimes_.capacity());
+}
+
 void
 Scene::update_elapsed_times()
 {
@@ -31,6 +31,10 @@
 #include "mesh.h"
 #include "vec.h"
 #include "program.h"
+#include "statistics.h"
+#include "gpu-timer.h"
+#include "perf-counters.h"
+#include "memory-usage.h"
 
 #include <math.h>
 
@@ -64,12 +68,85 @@ public:
         bool set;
     };
 
+    /**
+     * The lower bound (in seconds) of the frame time histogram.
+     */
+    static constexpr double frame_time_histogram_min = 0.0000625;
+
+    /**
+     * The phases of a frame, as timed by the main loop.
+     */
+    enum FramePhase {
+        FramePhaseClear,
+        FramePhaseDraw,
+        FramePhaseUpdate,
+        FramePhaseFrameEnd,
+        FramePhaseFlip,
+        FramePhaseSyncWait,
+        FramePhaseCount
+    };
+
+    /**
+     * Gets the name of a frame phase, as used in the results.
+     */
+    static const char *frame_phase_name(FramePhase phase);
+
+    struct PhaseStats {
+        double average;
+        double median;
+        double p90;
+        double p99;
+    };
+
     struct Stats {
         double average_frame_time;
         double average_user_time;
         double average_system_time;
         double cpu_busy_percent;
         double shader_compilation_time;
+        double min_frame_time;
+        double median_frame_time;
+        double p90_frame_time;
+        double p95_frame_time;
+        double p99_frame_time;
+        double max_frame_time;
+        double stddev_frame_time;
+        double average_gpu_time;
+        double frame_time_ci95;
+        double run_time;
+        bool converged;
+        unsigned int warmup_frames;
+        double average_warmup_frame_time;
+        double max_warmup_frame_time;
+        LogHistogram frame_time_histogram{frame_time_histogram_min, 16, 4};
+        PhaseStats phase_time[FramePhaseCount];
+        bool perf_available[PerfCounters::CounterCount];
+        double perf_per_frame[PerfCounters::CounterCount];
+        MemorySample memory_baseline;
+        MemorySample memory_peak;
+        MemorySample memory_final;
+    };
+
+    /**
+     * A scene-specific result of a benchmark run.
+     */
+    struct ExtraResult {
+        /** The name of the result in the log */
+        std::string name;
+        /** The name of the field in the results file */
+        std::string field;
+        std::string value;
+        /** The unit shown after the value in the log, if any */
+        std::string unit;
+    };
+
+    /**
+     * The CPU-side assets a scene loads with Model::load() and
+     * Texture::load().
+     */
+    struct Assets {
+        std::vector<std::string> models;
+        std::vector<std::string> textures;
     };
 
     /**
@@ -133,6 +210,13 @@ public:
      */
     bool running() { return running_; }
 
+    /**
+     * Gets whether this scene is in its warm-up phase.
+     *
+     * @return true if warming up, false otherwise
+     */
+    bool warming_up() { return warmingUp_; }
+
     /**
      * Sets whether this scene is running.
      *
@@ -154,6 +238,79 @@ public:
      */
     Stats stats();
 
+    /**
+     * Gets the scene-specific results of the last run, which are reported
+     * in addition to the common statistics.
+     *
+     * @return the results
+     */
+    virtual std::vector<ExtraResult> extra_results() { return std::vector<ExtraResult>(); }
+
+    /**
+     * Gets the assets that a run of this scene loads, so that they can be
+     * prefetched while another scene runs.
+     *
+     * The default implementation uses the "model" and "texture" options.
+     *
+     * @param options the options set for the run (all others have their
+     *                default values)
+     * @param assets the assets to add to
+     */
+    virtual void assets(const std::map<std::string, std::string> &options, Assets &assets);
+
+    /**
+     * Gets the duration (in seconds) of each frame rendered in the last run.
+     *
+     * @return the frame times
+     */
+    const std::vector<double> &frame_times() { return frameTimes_; }
+
+    /**
+     * Gets the duration (in seconds) of each warm-up frame rendered in the
+     * last run. Warm-up frames are not included in ::frame_times().
+     *
+     * @return the warm-up frame times
+     */
+    const std::vector<double> &warmup_frame_times() { return warmupFrameTimes_; }
+
+    /**
+     * Gets the GPU time (in seconds) of each frame rendered in the last run.
+     *
+     * GPU times are only recorded if requested with --results and supported
+     * by the GL implementation.
+     *
+     * @return the GPU frame times
+     */
+    const std::vector<double> &gpu_frame_times() { return gpuTimer_.frame_times(); }
+
+    /**
+     * Collects the GPU times of previous frames that are available.
+     *
+     * Meant to be called between frames, outside the timed frame phases.
+     * Never waits for the GPU.
+     */
+    void collect_gpu_times() { gpuTimer_.collect(); }
+
+    /**
+     * Records the time (in seconds) spent in each phase of the last frame.
+     *
+     * Phase times are only recorded if requested with --results, and not
+     * during the warm-up phase.
+     *
+     * @param times the phase times, indexed by FramePhase
+     */
+    void add_frame_phase_times(const double *times);
+
+    /**
+     * Gets the time (in seconds) spent in a phase of each frame rendered in
+     * the last run.
+     *
+     * @param phase the phase
+     *
+     * @return the phase times
+     */
+    const std::vector<double> &frame_phase_times(FramePhase phase) { return phaseTimes_[phase]; }
+
     /**
      * Gets the name of the scene.
      * @return the name of the scene
@@ -184,8 +341,12 @@ public:
 
     /**
      * Finish a benchmarking run.
+     *
+     * @param keep_loaded whether to keep the option-independent resources
+     *        (see ::load()) loaded for the next run of the same scene, which
+     *        must use the same GL context
      */
-    void finish();
+    void finish(bool keep_loaded = false);
 
     /**
      * Gets a dummy scene object reference.
@@ -212,6 +373,8 @@ public:
 protected:
     Scene(Canvas &pCanvas, const std::string &name);
     std::string construct_title(const std::string &title);
+    std::string option_value(const std::map<std::string, std::string> &options,
+                             const std::string &name);
 
     /**
      * Performs option-independent resource loading and configuration.
@@ -256,6 +419,12 @@ protected:
      */
     void update_elapsed_times();
 
+    /**
+     * Ends the warm-up phase, restarting all timers so that the warm-up
+     * frames are excluded from the benchmark results.
+     */
+    void end_warmup();
+
     struct ElapsedTime {
         double start = 0.0;
         double lastUpdate = 0.0;
@@ -270,10 +439,25 @@ protected:
     ElapsedTime userTime_;
     ElapsedTime systemTime_;
     ElapsedTime idleTime_;
+    std::vector<double> frameTimes_;
+    std::vector<double> warmupFrameTimes_;
+    RunningStats frameTimeStats_;
+    GPUTimer gpuTimer_;
+    PerfCounters perfCounters_;
+    MemoryMonitor memoryMonitor_;
+    std::vector<double> phaseTimes_[FramePhaseCount];
     unsigned currentFrame_;
     bool running_;
+    bool loaded_;
+    bool warmingUp_;
+    bool converged_;
     double duration_;      // Duration of run in seconds
     unsigned nframes_;
+    double warmupDuration_; // Minimum duration of warm-up in seconds
+    unsigned warmupFrames_; // Minimum number of warm-up frames
+    bool adaptive_;
+    double adaptiveTarget_; // Target relative CI half-width of frame time
+    double adaptiveMinDuration_;
 };
 
 /*
@@ -296,6 +480,7 @@ class SceneBuild : public Scene
 {
 public:
     SceneBuild(Canvas &pCanvas);
+    bool supported(bool show_errors);
     void update();
     void draw();
     ValidationResult validate();
@@ -408,6 +593,9 @@ public:
 
     ~SceneConditionals();
 
+    static std::string get_vertex_shader_source(int steps, bool conditionals);
+    static std::string get_fragment_shader_source(int steps, bool conditionals);
+
 protected:
     bool setup();
 };
@@ -420,6 +608,11 @@ public:
 
     ~SceneFunction();
 
+    static std::string get_vertex_shader_source(int steps, bool function,
+                                                const std::string &complexity);
+    static std::string get_fragment_shader_source(int steps, bool function,
+                                                  const std::string &complexity);
+
 protected:
     bool setup();
 };
@@ -432,6 +625,9 @@ public:
 
     ~SceneLoop();
 
+    static std::string get_vertex_shader_source(int steps, bool loop, bool uniform);
+    static std::string get_fragment_shader_source(int steps, bool loop, bool uniform);
+
 protected:
     bool setup();
 };
@@ -443,6 +639,7 @@ public:
     void update();
     void draw();
     ValidationResult validate();
+    void assets(const std::map<std::string, std::string> &options, Assets &assets);
 
     ~SceneBump();
 
@@ -471,6 +668,7 @@ public:
     void update();
     void draw();
     ValidationResult validate();
+    void assets(const std::map<std::string, std::string> &options, Assets &assets);
 
     ~SceneEffect2D();
 
@@ -492,6 +690,7 @@ public:
     void update();
     void draw();
     ValidationResult validate();
+    void assets(const std::map<std::string, std::string> &options, Assets &assets);
 
     ~ScenePulsar();
 
@@ -604,6 +803,7 @@ public:
     void update();
     void draw();
     ValidationResult validate();
+    void assets(const std::map<std::string, std::string> &options, Assets &assets);
 
 protected:
     bool setup();
@@ -620,6 +820,7 @@ public:
     void update();
     void draw();
     ValidationResult validate();
+    void assets(const std::map<std::string, std::string> &options, Assets &assets);
 
 protected:
     bool setup();
@@ -648,4 +849,24 @@ public:
     SceneClear(Canvas &pCanvas);
 };
 
+struct SceneShaderCompilePrivate;
+
+class SceneShaderCompile : public Scene
+{
+public:
+    SceneShaderCompile(Canvas &pCanvas);
+    bool supported(bool show_errors);
+    void draw();
+    std::vector<ExtraResult> extra_results();
+
+    ~SceneShaderCompile();
+
+protected:
+    bool setup();
+    void teardown();
+
+private:
+    SceneShaderCompilePrivate *priv_;
+};
+
 #endif
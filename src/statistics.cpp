@@ -0,0 +1,295 @@
+/*
+ * Copyright © 2026 Collabora Limited
+ *
+ * This file is part of the glmark2 OpenGL (ES) 2.0 benchmark.
+ *
+ * glmark2 is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * glmark2 is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * glmark2.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "statistics.h"
+
+#include <algorithm>
+#include <cmath>
+
+/**************
+ * Statistics *
+ **************/
+
+double
+Statistics::mean(const std::vector<double> &samples)
+{
+    if (samples.empty())
+        return 0.0;
+
+    double sum = 0.0;
+    for (auto s : samples)
+        sum += s;
+
+    return sum / samples.size();
+}
+
+double
+Statistics::stddev(const std::vector<double> &samples, double mean)
+{
+    if (samples.size() < 2)
+        return 0.0;
+
+    double sum_sq = 0.0;
+    for (auto s : samples)
+        sum_sq += (s - mean) * (s - mean);
+
+    return std::sqrt(sum_sq / (samples.size() - 1));
+}
+
+double
+Statistics::percentile(const std::vector<double> &sorted, double p)
+{
+    if (sorted.empty())
+        return 0.0;
+
+    double rank = p / 100.0 * (sorted.size() - 1);
+    size_t lower = static_cast<size_t>(std::floor(rank));
+    size_t upper = static_cast<size_t>(std::ceil(rank));
+
+    if (upper >= sorted.size())
+        return sorted.back();
+
+    double frac = rank - lower;
+
+    return sorted[lower] + frac * (sorted[upper] - sorted[lower]);
+}
+
+double
+Statistics::t_critical_95(double dof)
+{
+    /* Two-sided 95% critical values of the t-distribution, for 1-30 dof */
+    static const double t_table[] = {
+        12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+        2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+        2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042
+    };
+    static const size_t t_table_size = sizeof(t_table) / sizeof(*t_table);
+
+    if (dof < 1.0)
+        return t_table[0];
+
+    size_t n = static_cast<size_t>(dof);
+    /* Beyond the table, 1.96 + 2.4 / dof is within 0.2% of the exact value */
+    return n <= t_table_size ? t_table[n - 1] : 1.96 + 2.4 / dof;
+}
+
+double
+Statistics::ci95_half_width(const std::vector<double> &samples, double stddev)
+{
+    if (samples.size() < 2)
+        return 0.0;
+
+    return t_critical_95(samples.size() - 1) * stddev / std::sqrt(samples.size());
+}
+
+double
+Statistics::welch_ci95_half_width(const RunningStats &a, const RunningStats &b)
+{
+    if (a.count() < 2 || b.count() < 2)
+        return 0.0;
+
+    double var_a = a.variance() / a.count();
+    double var_b = b.variance() / b.count();
+
+    if (var_a + var_b == 0.0)
+        return 0.0;
+
+    /* Welch-Satterthwaite degrees of freedom */
+    double dof = (var_a + var_b) * (var_a + var_b) /
+                 (var_a * var_a / (a.count() - 1) + var_b * var_b / (b.count() - 1));
+
+    return t_critical_95(dof) * std::sqrt(var_a + var_b);
+}
+
+double
+Statistics::mann_whitney_p_value(const std::vector<double> &sorted_a,
+                                 const std::vector<double> &sorted_b)
+{
+    size_t na = sorted_a.size();
+    size_t nb = sorted_b.size();
+
+    if (na == 0 || nb == 0)
+        return 1.0;
+
+    /*
+     * Walk both sets in order, assigning the average rank to each group of
+     * tied values, and sum up the ranks of the first set.
+     */
+    double rank_sum_a = 0.0;
+    double tie_sum = 0.0;
+    double rank = 1.0;
+    size_t i = 0;
+    size_t j = 0;
+
+    while (i < na || j < nb) {
+        double value;
+        if (j >= nb || (i < na && sorted_a[i] <= sorted_b[j]))
+            value = sorted_a[i];
+        else
+            value = sorted_b[j];
+
+        double ties_a = 0.0;
+        double ties_b = 0.0;
+        for (; i < na && sorted_a[i] == value; i++)
+            ties_a++;
+        for (; j < nb && sorted_b[j] == value; j++)
+            ties_b++;
+
+        double ties = ties_a + ties_b;
+        rank_sum_a += ties_a * (rank + (ties - 1.0) / 2.0);
+        tie_sum += ties * ties * ties - ties;
+        rank += ties;
+    }
+
+    double n = static_cast<double>(na) + nb;
+    double u = rank_sum_a - na * (na + 1.0) / 2.0;
+    double mean_u = na * static_cast<double>(nb) / 2.0;
+    double var_u = na * static_cast<double>(nb) / 12.0 *
+                   ((n + 1.0) - tie_sum / (n * (n - 1.0)));
+
+    if (var_u <= 0.0)
+        return 1.0;
+
+    /* Normal approximation with continuity correction */
+    double z = std::max(std::fabs(u - mean_u) - 0.5, 0.0) / std::sqrt(var_u);
+
+    return std::erfc(z / std::sqrt(2.0));
+}
+
+bool
+Statistics::linear_fit(const std::vector<double> &x, const std::vector<double> &y,
+                       LinearFit &fit)
+{
+    size_t n = std::min(x.size(), y.size());
+
+    if (n < 2)
+        return false;
+
+    double mean_x = 0.0;
+    double mean_y = 0.0;
+    for (size_t i = 0; i < n; i++) {
+        mean_x += x[i];
+        mean_y += y[i];
+    }
+    mean_x /= n;
+    mean_y /= n;
+
+    /* Use centered sums for numerical stability */
+    double sxx = 0.0;
+    double sxy = 0.0;
+    double syy = 0.0;
+    for (size_t i = 0; i < n; i++) {
+        double dx = x[i] - mean_x;
+        double dy = y[i] - mean_y;
+        sxx += dx * dx;
+        sxy += dx * dy;
+        syy += dy * dy;
+    }
+
+    if (sxx <= 0.0)
+        return false;
+
+    fit.slope = sxy / sxx;
+    fit.intercept = mean_y - fit.slope * mean_x;
+    fit.r2 = syy > 0.0 ? sxy * sxy / (sxx * syy) : 1.0;
+
+    return true;
+}
+
+/****************
+ * RunningStats *
+ ****************/
+
+void
+RunningStats::add(double value)
+{
+    count_++;
+    double delta = value - mean_;
+    mean_ += delta / count_;
+    m2_ += delta * (value - mean_);
+}
+
+void
+RunningStats::clear()
+{
+    count_ = 0;
+    mean_ = 0.0;
+    m2_ = 0.0;
+}
+
+double
+RunningStats::variance() const
+{
+    return count_ < 2 ? 0.0 : m2_ / (count_ - 1);
+}
+
+double
+RunningStats::stddev() const
+{
+    return std::sqrt(variance());
+}
+
+double
+RunningStats::ci95_half_width() const
+{
+    return count_ < 2 ? 0.0 : 1.96 * stddev() / std::sqrt(count_);
+}
+
+/****************
+ * LogHistogram *
+ ****************/
+
+LogHistogram::LogHistogram(double min_value, unsigned int octaves,
+                           unsigned int buckets_per_octave) :
+    min_value_(min_value), buckets_per_octave_(buckets_per_octave),
+    counts_(octaves * buckets_per_octave, 0)
+{
+}
+
+void
+LogHistogram::add(double value)
+{
+    int bucket = 0;
+
+    if (value > min_value_)
+        bucket = static_cast<int>(std::log2(value / min_value_) * buckets_per_octave_);
+
+    if (bucket >= static_cast<int>(counts_.size()))
+        bucket = counts_.size() - 1;
+
+    counts_[bucket]++;
+}
+
+void
+LogHistogram::clear()
+{
+    for (auto &c : counts_)
+        c = 0;
+}
+
+double
+LogHistogram::lower_bound(unsigned int bucket) const
+{
+    return min_value_ * std::exp2(static_cast<double>(bucket) / buckets_per_octave_);
+}
+
+double
+LogHistogram::upper_bound(unsigned int bucket) const
+{
+    return lower_bound(bucket + 1);
+}
@@ -0,0 +1,195 @@
+/*
+ * Copyright © 2026 Collabora Limited
+ *
+ * This file is part of the glmark2 OpenGL (ES) 2.0 benchmark.
+ *
+ * glmark2 is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * glmark2 is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * glmark2.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef GLMARK2_STATISTICS_H_
+#define GLMARK2_STATISTICS_H_
+
+#include <vector>
+#include <stdint.h>
+
+class RunningStats;
+
+/**
+ * Helpers for computing summary statistics over sets of samples.
+ */
+struct Statistics {
+    /**
+     * The result of a least squares fit of a line y = slope * x + intercept.
+     */
+    struct LinearFit {
+        double slope;
+        double intercept;
+        /** The coefficient of determination */
+        double r2;
+    };
+
+    /**
+     * Gets the arithmetic mean of a set of samples.
+     *
+     * @return the mean, or 0.0 if there are no samples
+     */
+    static double mean(const std::vector<double> &samples);
+
+    /**
+     * Gets the sample standard deviation of a set of samples.
+     *
+     * @param samples the samples
+     * @param mean the mean of the samples
+     *
+     * @return the standard deviation, or 0.0 if there are fewer than 2 samples
+     */
+    static double stddev(const std::vector<double> &samples, double mean);
+
+    /**
+     * Gets a percentile of a set of samples, interpolating linearly
+     * between the closest ranks.
+     *
+     * @param sorted the samples, sorted in ascending order
+     * @param p the percentile to get, in the range [0.0, 100.0]
+     *
+     * @return the percentile value, or 0.0 if there are no samples
+     */
+    static double percentile(const std::vector<double> &sorted, double p);
+
+    /**
+     * Gets the two-sided 95% critical value of the Student's t-distribution.
+     *
+     * @param dof the degrees of freedom (rounded down if not an integer)
+     *
+     * @return the critical value
+     */
+    static double t_critical_95(double dof);
+
+    /**
+     * Gets the half-width of the 95% confidence interval of the mean of a
+     * set of samples, using the Student's t-distribution.
+     *
+     * @param samples the samples
+     * @param stddev the standard deviation of the samples
+     *
+     * @return the half-width, or 0.0 if there are fewer than 2 samples
+     */
+    static double ci95_half_width(const std::vector<double> &samples, double stddev);
+
+    /**
+     * Gets the half-width of the 95% confidence interval of the difference
+     * between the means of two sets of samples, using Welch's t-test.
+     *
+     * @return the half-width, or 0.0 if either set has fewer than 2 samples
+     */
+    static double welch_ci95_half_width(const RunningStats &a, const RunningStats &b);
+
+    /**
+     * Gets the two-sided p-value of the Mann-Whitney U test, i.e., the
+     * probability of the samples if neither set tends to have larger values
+     * than the other.
+     *
+     * Uses the normal approximation with a correction for ties, so it runs
+     * in linear time (after sorting) and doesn't need any extra memory.
+     *
+     * @param sorted_a the first set of samples, sorted in ascending order
+     * @param sorted_b the second set of samples, sorted in ascending order
+     *
+     * @return the p-value, or 1.0 if either set is empty
+     */
+    static double mann_whitney_p_value(const std::vector<double> &sorted_a,
+                                       const std::vector<double> &sorted_b);
+
+    /**
+     * Fits a line to a set of points using ordinary least squares.
+     *
+     * @param x the x coordinates of the points
+     * @param y the y coordinates of the points
+     * @param fit the fitted line
+     *
+     * @return whether the fit succeeded, i.e., there are at least 2 points
+     *         with different x coordinates
+     */
+    static bool linear_fit(const std::vector<double> &x, const std::vector<double> &y,
+                           LinearFit &fit);
+};
+
+/**
+ * Incrementally computed mean and variance of a stream of samples.
+ *
+ * Uses Welford's algorithm, so adding a sample takes constant time and
+ * memory, and is numerically stable.
+ */
+class RunningStats
+{
+public:
+    RunningStats() { clear(); }
+
+    void add(double value);
+    void clear();
+
+    uint64_t count() const { return count_; }
+    double mean() const { return mean_; }
+    double variance() const;
+    double stddev() const;
+
+    /**
+     * Gets the half-width of the 95% confidence interval of the mean,
+     * using the normal approximation.
+     *
+     * @return the half-width, or 0.0 if there are fewer than 2 samples
+     */
+    double ci95_half_width() const;
+
+private:
+    uint64_t count_;
+    double mean_;
+    double m2_;
+};
+
+/**
+ * A histogram with logarithmically spaced buckets.
+ *
+ * The bucket bounds are fixed at construction time, so adding samples never
+ * allocates memory. Samples below the lower bound of the first bucket or
+ * above the upper bound of the last bucket are accumulated in the first and
+ * last bucket, respectively.
+ */
+class LogHistogram
+{
+public:
+    /**
+     * Creates a histogram.
+     *
+     * @param min_value the lower bound of the first bucket (must be > 0)
+     * @param octaves the number of doublings covered by the histogram
+     * @param buckets_per_octave the number of buckets per doubling
+     */
+    LogHistogram(double min_value, unsigned int octaves,
+                 unsigned int buckets_per_octave);
+
+    void add(double value);
+    void clear();
+
+    unsigned int size() const { return counts_.size(); }
+    uint64_t count(unsigned int bucket) const { return counts_[bucket]; }
+    double lower_bound(unsigned int bucket) const;
+    double upper_bound(unsigned int bucket) const;
+
+private:
+    double min_value_;
+    unsigned int buckets_per_octave_;
+    std::vector<uint64_t> counts_;
+};
+
+#endif /* GLMARK2_STATISTICS_H_ */
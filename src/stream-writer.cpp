@@ -0,0 +1,232 @@
+/*
+ * Copyright © 2026 Collabora Limited
+ *
+ * This file is part of the glmark2 OpenGL (ES) 2.0 benchmark.
+ *
+ * glmark2 is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * glmark2 is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * glmark2.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "stream-writer.h"
+#include "log.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+#if !defined(_WIN32)
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <cerrno>
+#include <climits>
+#include <csignal>
+#include <cstdlib>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+
+#if !defined(_WIN32)
+int
+open_target(const std::string &target)
+{
+    if (target.compare(0, 5, "unix:") == 0) {
+        std::string path = target.substr(5);
+        struct sockaddr_un addr;
+
+        if (path.size() >= sizeof(addr.sun_path)) {
+            Log::error("Socket path %s is too long\n", path.c_str());
+            return -1;
+        }
+
+        memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        memcpy(addr.sun_path, path.c_str(), path.size());
+
+        int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd < 0 ||
+            connect(fd, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr)) < 0)
+        {
+            Log::error("Failed to connect to socket %s: %s\n",
+                       path.c_str(), strerror(errno));
+            if (fd >= 0)
+                close(fd);
+            return -1;
+        }
+
+        return fd;
+    }
+
+    if (target.compare(0, 3, "fd:") == 0) {
+        char *end;
+        long fd = strtol(target.c_str() + 3, &end, 10);
+
+        if (target.size() == 3 || *end != '\0' || fd < 0 ||
+            fcntl(fd, F_GETFD) < 0)
+        {
+            Log::error("Invalid file descriptor %s\n", target.c_str() + 3);
+            return -1;
+        }
+
+        return fd;
+    }
+
+    /* Opening a named pipe blocks until there is a reader */
+    int fd = ::open(target.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (fd < 0)
+        Log::error("Failed to open %s: %s\n", target.c_str(), strerror(errno));
+
+    return fd;
+}
+#endif
+
+}
+
+StreamWriter::StreamWriter(int fd, bool owned, size_t capacity) :
+    fd_(fd), owned_(owned), socket_(false), buffer_(capacity), head_(0), tail_(0),
+    stop_(false), dropped_(0)
+{
+#if !defined(_WIN32)
+    struct stat st;
+    socket_ = fstat(fd_, &st) == 0 && S_ISSOCK(st.st_mode);
+#endif
+
+    thread_ = std::thread(&StreamWriter::run, this);
+}
+
+StreamWriter::~StreamWriter()
+{
+    stop_ = true;
+    thread_.join();
+
+#if !defined(_WIN32)
+    if (owned_)
+        close(fd_);
+#endif
+
+    if (dropped_ > 0)
+        Log::warning("Dropped %llu writes to a slow stream reader\n",
+                     static_cast<unsigned long long>(dropped_));
+}
+
+StreamWriter *
+StreamWriter::open(const std::string &target, size_t capacity)
+{
+#if !defined(_WIN32)
+    int fd = open_target(target);
+    if (fd < 0)
+        return nullptr;
+
+    /*
+     * The writer thread must never block indefinitely, so that it can
+     * be stopped even if the reader is stuck. A reader going away is
+     * reported as EPIPE instead of killing the process. The flags of
+     * inherited descriptors are shared with other processes, and with
+     * our own stdio for fd:1 and fd:2, so they are left alone.
+     */
+    bool owned = target.compare(0, 3, "fd:") != 0;
+    if (owned)
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    signal(SIGPIPE, SIG_IGN);
+
+    return new StreamWriter(fd, owned, capacity);
+#else
+    Log::error("Streaming to %s is not supported on this platform\n", target.c_str());
+    static_cast<void>(capacity);
+    return nullptr;
+#endif
+}
+
+bool
+StreamWriter::write(const std::string &data)
+{
+    size_t capacity = buffer_.size();
+    uint64_t head = head_.load(std::memory_order_relaxed);
+    uint64_t tail = tail_.load(std::memory_order_acquire);
+
+    if (data.size() > capacity - (head - tail)) {
+        dropped_++;
+        return false;
+    }
+
+    size_t offset = head % capacity;
+    size_t first = std::min(data.size(), capacity - offset);
+
+    memcpy(&buffer_[offset], data.data(), first);
+    memcpy(&buffer_[0], data.data() + first, data.size() - first);
+
+    head_.store(head + data.size(), std::memory_order_release);
+
+    return true;
+}
+
+void
+StreamWriter::run()
+{
+#if !defined(_WIN32)
+    using clock = std::chrono::steady_clock;
+    size_t capacity = buffer_.size();
+    /* When stopping, give a slow reader a little time to catch up */
+    clock::time_point deadline = clock::time_point::max();
+
+    while (clock::now() < deadline) {
+        /* Check for stopping first, so that no data queued before is missed */
+        bool stopping = stop_;
+        uint64_t tail = tail_.load(std::memory_order_relaxed);
+        uint64_t head = head_.load(std::memory_order_acquire);
+
+        if (stopping && deadline == clock::time_point::max())
+            deadline = clock::now() + std::chrono::seconds(1);
+
+        if (head == tail) {
+            if (stopping)
+                break;
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            continue;
+        }
+
+        size_t offset = tail % capacity;
+        size_t size = std::min<uint64_t>(head - tail, capacity - offset);
+
+        /*
+         * Inherited descriptors may be blocking, but a write of at most
+         * PIPE_BUF bytes doesn't block once they are writable.
+         */
+        if (!owned_ && !socket_) {
+            struct pollfd pfd = {fd_, POLLOUT, 0};
+            if (poll(&pfd, 1, 100) <= 0)
+                continue;
+            size = std::min<size_t>(size, PIPE_BUF);
+        }
+
+        ssize_t ret = socket_ ? send(fd_, &buffer_[offset], size, MSG_DONTWAIT) :
+                                ::write(fd_, &buffer_[offset], size);
+
+        if (ret < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            struct pollfd pfd = {fd_, POLLOUT, 0};
+            poll(&pfd, 1, 100);
+            continue;
+        }
+        else if (ret < 0 && errno != EINTR) {
+            Log::error("Failed to write to stream: %s\n", strerror(errno));
+            break;
+        }
+
+        if (ret > 0)
+            tail_.store(tail + ret, std::memory_order_release);
+    }
+#endif
+}
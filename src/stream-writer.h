@@ -0,0 +1,90 @@
+/*
+ * Copyright © 2026 Collabora Limited
+ *
+ * This file is part of the glmark2 OpenGL (ES) 2.0 benchmark.
+ *
+ * glmark2 is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * glmark2 is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * glmark2.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef GLMARK2_STREAM_WRITER_H_
+#define GLMARK2_STREAM_WRITER_H_
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+#include <stdint.h>
+
+/**
+ * Writes data to a file descriptor from a background thread.
+ *
+ * Data is passed to the writer thread through a lock-free single-producer,
+ * single-consumer ring buffer, so writing never blocks the caller, even if
+ * the reader on the other side is slow or stuck. If the ring buffer is full,
+ * the data is dropped instead.
+ *
+ * Inherited file descriptors are shared with other processes, so their
+ * flags are left alone and they are never closed by the writer. Instead,
+ * the writer waits for them to become writable and writes at most PIPE_BUF
+ * bytes at a time.
+ */
+class StreamWriter
+{
+public:
+    ~StreamWriter();
+
+    /**
+     * Opens a stream.
+     *
+     * @param target where to write to: 'unix:PATH' for a Unix domain stream
+     *               socket, 'fd:N' for an inherited file descriptor, or the
+     *               path of a named pipe or regular file
+     * @param capacity the size of the ring buffer in bytes
+     *
+     * @return the stream, or nullptr if the target couldn't be opened
+     */
+    static StreamWriter *open(const std::string &target, size_t capacity);
+
+    /**
+     * Queues data to be written.
+     *
+     * Must only be called from a single thread.
+     *
+     * @return whether the data was queued, i.e., it wasn't dropped
+     */
+    bool write(const std::string &data);
+
+    /**
+     * Gets the number of write() calls whose data was dropped.
+     */
+    uint64_t dropped() const { return dropped_; }
+
+private:
+    StreamWriter(int fd, bool owned, size_t capacity);
+    void run();
+
+    int fd_;
+    /* Whether the writer opened the descriptor, rather than inheriting it */
+    bool owned_;
+    /* Whether the descriptor is a socket, written with non-blocking sends */
+    bool socket_;
+    std::vector<char> buffer_;
+    /* Total bytes ever written to and read from the buffer */
+    std::atomic<uint64_t> head_;
+    std::atomic<uint64_t> tail_;
+    std::atomic<bool> stop_;
+    uint64_t dropped_;
+    std::thread thread_;
+};
+
+#endif /* GLMARK2_STREAM_WRITER_H_ */
@@ -26,9 +26,12 @@
 #include "options.h"
 #include "util.h"
 #include "image-reader.h"
+#include "trace.h"
+#include "asset-prefetcher.h"
 
 #include <algorithm>
 #include <cstdarg>
+#include <future>
 #include <vector>
 
 class ImageData {
@@ -95,14 +98,43 @@ setup_texture(GLuint *tex, ImageData &image, GLint min_filter, GLint mag_filter)
         GLExtensions::GenerateMipmap(GL_TEXTURE_2D);
 }
 
+/*
+ * Decodes the image file of a texture, returning an empty pointer if it
+ * can't be decoded.
+ */
+static std::unique_ptr<ImageData>
+load_image(const TextureDescriptor &desc)
+{
+    std::unique_ptr<ImageData> image(new ImageData());
+
+    if (desc.filetype() == TextureDescriptor::FileTypePNG) {
+        PNGReader reader(desc.pathname());
+        if (!image->load(reader))
+            image.reset();
+    }
+    else if (desc.filetype() == TextureDescriptor::FileTypeJPEG) {
+        JPEGReader reader(desc.pathname());
+        if (!image->load(reader))
+            image.reset();
+    }
+
+    return image;
+}
+
 namespace TexturePrivate
 {
 TextureMap textureMap;
+/* Decoded images, kept with --reuse-context until the scene using them changes */
+std::map<std::string, std::unique_ptr<ImageData>> imageCache;
+/* Images being decoded by the asset prefetcher, for the next scene */
+std::map<std::string, std::future<std::unique_ptr<ImageData>>> prefetched;
 }
 
 bool
 Texture::load(const std::string &textureName, GLuint *pTexture, ...)
 {
+    TraceSpan span("load_texture", "asset", textureName);
+
     // Make sure the named texture is in the map.
     TextureMap::const_iterator textureIt = TexturePrivate::textureMap.find(textureName);
     if (textureIt == TexturePrivate::textureMap.end())
@@ -110,19 +142,31 @@ Texture::load(const std::string &textureName, GLuint *pTexture, ...)
         return false;
     }
 
-    // Pull the pathname out of the descriptor and use it for the PNG load.
-    TextureDescriptor* desc = textureIt->second.get();
-    ImageData image;
+    std::unique_ptr<ImageData> loaded;
+    ImageData *image = nullptr;
 
-    if (desc->filetype() == TextureDescriptor::FileTypePNG) {
-        PNGReader reader(desc->pathname());
-        if (!image.load(reader))
-            return false;
-    }
-    else if (desc->filetype() == TextureDescriptor::FileTypeJPEG) {
-        JPEGReader reader(desc->pathname());
-        if (!image.load(reader))
+    auto cacheIt = TexturePrivate::imageCache.find(textureName);
+    if (cacheIt != TexturePrivate::imageCache.end())
+        image = cacheIt->second.get();
+
+    if (!image) {
+        auto prefetchIt = TexturePrivate::prefetched.find(textureName);
+        if (prefetchIt != TexturePrivate::prefetched.end()) {
+            // Wait for the prefetcher if it is still decoding the image
+            loaded = prefetchIt->second.get();
+            TexturePrivate::prefetched.erase(prefetchIt);
+        }
+
+        if (!loaded)
+            loaded = load_image(*textureIt->second);
+        if (!loaded)
             return false;
+
+        image = loaded.get();
+
+        // Only a reused context can set up the scene again with the same image
+        if (Options::reuse_context)
+            TexturePrivate::imageCache[textureName] = std::move(loaded);
     }
 
     va_list ap;
@@ -131,7 +175,7 @@ Texture::load(const std::string &textureName, GLuint *pTexture, ...)
 
     while ((arg = va_arg(ap, GLint)) != 0) {
         GLint arg2 = va_arg(ap, GLint);
-        setup_texture(pTexture, image, arg, arg2);
+        setup_texture(pTexture, *image, arg, arg2);
         pTexture++;
     }
 
@@ -140,6 +184,45 @@ Texture::load(const std::string &textureName, GLuint *pTexture, ...)
     return true;
 }
 
+void
+Texture::clear_cache()
+{
+    TexturePrivate::imageCache.clear();
+}
+
+void
+Texture::prefetch(const std::vector<std::string> &names)
+{
+    const TextureMap &textureMap = find_textures();
+
+    for (auto it = TexturePrivate::prefetched.begin(); it != TexturePrivate::prefetched.end();) {
+        if (std::find(names.begin(), names.end(), it->first) == names.end())
+            it = TexturePrivate::prefetched.erase(it);
+        else
+            ++it;
+    }
+
+    for (const auto &name : names) {
+        TextureMap::const_iterator textureIt = textureMap.find(name);
+        if (textureIt == textureMap.end() ||
+            TexturePrivate::imageCache.count(name) ||
+            TexturePrivate::prefetched.count(name))
+        {
+            continue;
+        }
+
+        const TextureDescriptor *desc = textureIt->second.get();
+        auto task = std::make_shared<std::packaged_task<std::unique_ptr<ImageData>()>>(
+            [desc, name]() {
+                TraceSpan span("prefetch_texture", "asset", name);
+                return load_image(*desc);
+            });
+
+        TexturePrivate::prefetched[name] = task->get_future();
+        AssetPrefetcher::add_task([task]() { (*task)(); });
+    }
+}
+
 const TextureMap&
 Texture::find_textures()
 {
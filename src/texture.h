@@ -27,6 +27,7 @@
 #include "gl-headers.h"
 
 #include <string>
+#include <vector>
 #include <map>
 #include <memory>
 #include <filesystem>
@@ -84,6 +85,23 @@ public:
      * @return:     a map containing information about the located textures
      */
     static const TextureMap& find_textures();
+    /**
+     * Release the images cached by Texture::load().
+     *
+     * With --reuse-context, loading a texture that was loaded before since
+     * the last call of this method reuses the decoded image instead of
+     * reading the file again.
+     */
+    static void clear_cache();
+    /**
+     * Start decoding images on the asset prefetcher thread.
+     *
+     * Texture::load() picks up the decoded images. Images that were
+     * prefetched before, but not loaded since, are dropped.
+     *
+     * @names:      the names of the textures to decode
+     */
+    static void prefetch(const std::vector<std::string> &names);
 };
 
 #endif
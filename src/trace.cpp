@@ -0,0 +1,148 @@
+/*
+ * Copyright © 2026 Collabora Limited
+ *
+ * This file is part of the glmark2 OpenGL (ES) 2.0 benchmark.
+ *
+ * glmark2 is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * glmark2 is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * glmark2.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "trace.h"
+#include "log.h"
+#include "results-file.h"
+#include "util.h"
+
+#include <atomic>
+#include <fstream>
+#include <mutex>
+#include <vector>
+
+namespace
+{
+
+struct TraceEvent {
+    const char *name;
+    const char *category;
+    uint64_t start;
+    uint64_t duration;
+    unsigned int thread;
+    std::string detail;
+};
+
+std::ofstream trace_fs;
+std::vector<TraceEvent> trace_events;
+std::mutex trace_mutex;
+bool trace_first_event = true;
+
+/**
+ * Gets a small id for the calling thread, to use as the trace thread id.
+ */
+unsigned int
+thread_id()
+{
+    static std::atomic<unsigned int> next_id{1};
+    thread_local unsigned int id = next_id++;
+
+    return id;
+}
+
+}
+
+bool Trace::enabled_ = false;
+
+bool
+Trace::init(const std::string &file)
+{
+    if (file.empty())
+        return true;
+
+    trace_fs.open(file);
+    if (!trace_fs) {
+        Log::error("Failed to open trace file %s\n", file.c_str());
+        return false;
+    }
+
+    /* Reserve enough room for a few seconds of frames with their phases */
+    trace_events.reserve(1 << 16);
+    trace_fs << "[" << std::endl;
+    enabled_ = true;
+
+    Log::debug("Writing trace to %s\n", file.c_str());
+
+    return true;
+}
+
+void
+Trace::add_span(const char *name, const char *category,
+                uint64_t start, uint64_t end, const std::string &detail)
+{
+    if (!enabled_)
+        return;
+
+    std::lock_guard<std::mutex> lock(trace_mutex);
+    trace_events.push_back({name, category, start, end - start, thread_id(), detail});
+}
+
+void
+Trace::flush()
+{
+    if (!enabled_)
+        return;
+
+    std::lock_guard<std::mutex> lock(trace_mutex);
+
+    for (auto &event : trace_events) {
+        trace_fs << (trace_first_event ? "" : ",\n")
+                 << "{\"name\":\"" << event.name << "\""
+                 << ",\"cat\":\"" << event.category << "\""
+                 << ",\"ph\":\"X\""
+                 << ",\"ts\":" << event.start
+                 << ",\"dur\":" << event.duration
+                 << ",\"pid\":1,\"tid\":" << event.thread;
+        if (!event.detail.empty())
+            trace_fs << ",\"args\":{\"detail\":\"" << ResultsFile::json_escape(event.detail) << "\"}";
+        trace_fs << "}";
+        trace_first_event = false;
+    }
+
+    trace_fs.flush();
+    trace_events.clear();
+}
+
+void
+Trace::finish()
+{
+    if (!enabled_)
+        return;
+
+    flush();
+    trace_fs << "\n]" << std::endl;
+    trace_fs.close();
+    enabled_ = false;
+}
+
+/*************
+ * TraceSpan *
+ *************/
+
+TraceSpan::TraceSpan(const char *name, const char *category,
+                     const std::string &detail) :
+    name_(name), category_(category), detail_(detail),
+    start_(Trace::enabled() ? Util::get_timestamp_us() : 0)
+{
+}
+
+TraceSpan::~TraceSpan()
+{
+    if (Trace::enabled())
+        Trace::add_span(name_, category_, start_, Util::get_timestamp_us(), detail_);
+}
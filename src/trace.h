@@ -0,0 +1,95 @@
+/*
+ * Copyright © 2026 Collabora Limited
+ *
+ * This file is part of the glmark2 OpenGL (ES) 2.0 benchmark.
+ *
+ * glmark2 is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * glmark2 is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * glmark2.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef GLMARK2_TRACE_H_
+#define GLMARK2_TRACE_H_
+
+#include <string>
+#include <stdint.h>
+
+/**
+ * Records spans of time in the Chrome trace event format.
+ *
+ * Spans are buffered in memory and written to the trace file only when
+ * flush() is called, which should happen outside of time-critical code
+ * (e.g. between benchmarks). Timestamps are those of
+ * Util::get_timestamp_us(), i.e. the monotonic clock in microseconds.
+ */
+class Trace
+{
+public:
+    /**
+     * Starts tracing to a file.
+     *
+     * @param file the file to write the trace to, or an empty string to
+     *             disable tracing
+     *
+     * @return whether the operation succeeded
+     */
+    static bool init(const std::string &file);
+
+    /**
+     * Whether tracing is enabled.
+     */
+    static bool enabled() { return enabled_; }
+
+    /**
+     * Records a span.
+     *
+     * @param name the name of the span (must be a string literal)
+     * @param category the category of the span (must be a string literal)
+     * @param start the start timestamp in microseconds
+     * @param end the end timestamp in microseconds
+     * @param detail optional information to attach to the span
+     */
+    static void add_span(const char *name, const char *category,
+                         uint64_t start, uint64_t end,
+                         const std::string &detail = std::string());
+
+    /**
+     * Writes the buffered spans to the trace file.
+     */
+    static void flush();
+
+    /**
+     * Writes the buffered spans and completes the trace file.
+     */
+    static void finish();
+
+private:
+    static bool enabled_;
+};
+
+/**
+ * Records a span covering the lifetime of the object, if tracing is enabled.
+ */
+class TraceSpan
+{
+public:
+    TraceSpan(const char *name, const char *category,
+              const std::string &detail = std::string());
+    ~TraceSpan();
+
+private:
+    const char *name_;
+    const char *category_;
+    std::string detail_;
+    uint64_t start_;
+};
+
+#endif /* GLMARK2_TRACE_H_ */